@@ -0,0 +1,114 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   BoardWidget.cpp
+ * Author: azarias
+ *
+ * Created on 1/3/2018
+ */
+#include "BoardWidget.hpp"
+
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+
+#include <algorithm>
+
+BoardWidget::BoardWidget(const BattleField &field, QWidget *parent) :
+    QWidget(parent),
+    mField(field)
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    setAttribute(Qt::WA_OpaquePaintEvent);//every pixel is painted
+}
+
+void BoardWidget::refresh()
+{
+    update();
+}
+
+void BoardWidget::refreshSquare(const Coordinates &coords)
+{
+    if(coords.isValid())update(squareRect(coords));
+}
+
+QSize BoardWidget::sizeHint() const
+{
+    return QSize(Geometry::WIDTH * mSquareSize + 1, Geometry::HEIGHT * mSquareSize + 1);
+}
+
+QRect BoardWidget::squareRect(const Coordinates &coords) const
+{
+    //squares fill the whole widget, the rounding is spread over the squares
+    int left = coords.x * (width() - 1) / Geometry::WIDTH;
+    int top = coords.y * (height() - 1) / Geometry::HEIGHT;
+    int right = (coords.x + 1) * (width() - 1) / Geometry::WIDTH;
+    int bottom = (coords.y + 1) * (height() - 1) / Geometry::HEIGHT;
+    return QRect(left, top, right - left + 1, bottom - top + 1);
+}
+
+Coordinates BoardWidget::squareAt(const QPoint &position) const
+{
+    if(position.x() < 0 || position.y() < 0 || width() <= 1 || height() <= 1)return Coordinates(-1, -1);
+    return Coordinates(position.x() * Geometry::WIDTH / (width() - 1),
+                       position.y() * Geometry::HEIGHT / (height() - 1));
+}
+
+void BoardWidget::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    painter.fillRect(event->rect(), palette().window());
+
+    //only the squares in the area to repaint
+    Coordinates first = squareAt(event->rect().topLeft());
+    Coordinates last = squareAt(event->rect().bottomRight());
+    int lastX = std::min(last.x, Geometry::WIDTH - 1);
+    int lastY = std::min(last.y, Geometry::HEIGHT - 1);
+
+    for(int y = std::max(first.y, 0); y <= lastY; ++y){
+        for(int x = std::max(first.x, 0); x <= lastX; ++x){
+            Coordinates coords(x, y);
+            QRect rect = squareRect(coords);
+
+            painter.setPen(palette().mid().color());
+            painter.drawRect(rect.adjusted(0, 0, -1, -1));
+
+            const std::shared_ptr<Unit> &unit = mField.unitAt(coords);
+            if(unit){
+                painter.setPen(unit->getColor() == mField.getId() ? Qt::blue : palette().text().color());
+                painter.drawText(rect, Qt::AlignCenter, unit->strType());
+            }
+        }
+    }
+}
+
+void BoardWidget::mousePressEvent(QMouseEvent *event)
+{
+    Coordinates coords = squareAt(event->pos());
+    if(event->button() == Qt::LeftButton && coords.isValid()){
+        emit squareClicked(coords);
+    }
+    QWidget::mousePressEvent(event);
+}
@@ -0,0 +1,116 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   BoardWidget.hpp
+ * Author: azarias
+ *
+ * Created on 1/3/2018
+ */
+#ifndef BOARDWIDGET_HPP
+#define BOARDWIDGET_HPP
+
+#include <QWidget>
+
+#include "battlefield.hpp"
+#include "coordinates.hpp"
+
+/**
+ * @brief The BoardWidget class
+ * displays the battlefield : the grid and the units
+ * are painted by the widget itself (no child widget),
+ * only the squares that changed are repainted
+ */
+class BoardWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief BoardWidget constructor
+     * @param field the battlefield to display, it must
+     * outlive the widget
+     * @param parent
+     */
+    explicit BoardWidget(const BattleField &field, QWidget *parent = 0);
+
+    /**
+     * @brief refresh repaints the whole board
+     * (for example when a new board was received)
+     */
+    void refresh();
+
+    /**
+     * @brief refreshSquare repaints the square at the given
+     * coordinates, using the unit present on the battlefield
+     * @param coords
+     */
+    void refreshSquare(const Coordinates &coords);
+
+    /**
+     * @brief sizeHint
+     * @return the size needed to display all the squares
+     */
+    QSize sizeHint() const override;
+
+signals:
+    /**
+     * @brief squareClicked emitted when a square is clicked
+     * @param coords the coordinates of the square
+     */
+    void squareClicked(const Coordinates &coords);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+    void mousePressEvent(QMouseEvent *event) override;
+
+private:
+    /**
+     * @brief squareRect
+     * @param coords
+     * @return the rectangle of the square at the given coordinates
+     */
+    QRect squareRect(const Coordinates &coords) const;
+
+    /**
+     * @brief squareAt
+     * @param position position in the widget
+     * @return the coordinates of the square at the given position
+     * (invalid coordinates when outside of the board)
+     */
+    Coordinates squareAt(const QPoint &position) const;
+
+    /**
+     * @brief mField the battlefield displayed
+     */
+    const BattleField &mField;
+
+    /**
+     * @brief mSquareSize the minimum size of a square, in pixels
+     */
+    static const int mSquareSize = 30;
+};
+
+#endif // BOARDWIDGET_HPP
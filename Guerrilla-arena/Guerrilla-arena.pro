@@ -0,0 +1,79 @@
+#-------------------------------------------------
+#
+# Arena : plays games between two engines on a local
+# stand-in of the Guerrilla server, using all the
+# cores, and prints the win rates and times
+#
+#-------------------------------------------------
+
+QT       += network websockets
+
+QT       -= gui
+
+INCLUDEPATH += ".."
+
+TARGET = Guerrilla-arena
+CONFIG   += console c++14 thread
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+include(../geometry.pri)
+include(../trace.pri)
+include(../simd.pri)
+include(../sharedmemory.pri)
+
+SOURCES += \
+        main.cpp  \
+        localserver.cpp \
+        ..\battlefield.cpp \
+        ..\unit.cpp \
+        ..\action.cpp \
+        ..\tree.cpp \
+        ..\zobrist.cpp \
+        ..\openingbook.cpp \
+        ..\tablebase.cpp \
+        ..\transpositiontable.cpp \
+        ..\targets.cpp \
+        ..\engine.cpp \
+        ..\gamerecord.cpp \
+        ..\gamesession.cpp \
+        ..\searchstats.cpp \
+        ..\trace.cpp \
+        ..\evaluation.cpp \
+        ..\movegenerator.cpp \
+        ..\network.cpp \
+        ..\latency.cpp \
+        ..\metrics.cpp \
+        ..\metricsserver.cpp \
+        ..\boardsync.cpp
+
+HEADERS += \
+        localserver.hpp \
+    ..\battlefield.hpp \
+    ..\unit.hpp \
+    ..\action.hpp \
+    ..\coordinates.hpp \
+    ..\tree.hpp \
+    ..\zobrist.hpp \
+    ..\openingbook.hpp \
+    ..\tablebase.hpp \
+    ..\transpositiontable.hpp \
+    ..\searchcache.hpp \
+    ..\targets.hpp \
+    ..\geometry.hpp \
+    ..\engine.hpp \
+    ..\gamerecord.hpp \
+    ..\gamesession.hpp \
+    ..\searchstats.hpp \
+    ..\trace.hpp \
+    ..\evaluation.hpp \
+    ..\searchoptions.hpp \
+    ..\movegenerator.hpp \
+    ..\network.hpp \
+    ..\latency.hpp \
+    ..\metrics.hpp \
+    ..\metricsserver.hpp \
+    ..\symmetry.hpp \
+    ..\boardsync.hpp
@@ -0,0 +1,177 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   localserver.cpp
+ * Author: azarias
+ *
+ * Created on 3/3/2018
+ */
+#include "localserver.hpp"
+
+#include <QJsonDocument>
+
+LocalServer::LocalServer(const BattleField &start, int maxTurns):
+    mField(start),
+    mMaxTurns(maxTurns)
+{
+
+}
+
+void LocalServer::join(Unit::COLOR color, Connection &connection)
+{
+    mConnections[color] = &connection;
+}
+
+void LocalServer::receive(Unit::COLOR color, const QJsonObject &message)
+{
+    mQueue.push_back({false, color, message});
+}
+
+LocalServer::RESULT LocalServer::run()
+{
+    for(Unit::COLOR color : {Unit::WHITE, Unit::BLACK}){
+        sendTo(color, "your_id", int(color));
+    }
+
+    while(!mQueue.empty()){
+        Message next = mQueue.front();
+        mQueue.pop_front();
+
+        if(next.toClient){
+            QByteArray json = QJsonDocument(next.message).toJson(QJsonDocument::Compact);
+            mConnections[next.color]->deliver(QString::fromUtf8(json));
+        }else if(mResult == PLAYING){
+            handle(next.color, next.message);
+        }
+    }
+
+    //nothing left to do, but not finished : a client stopped playing
+    if(mResult == PLAYING)mResult = DRAW;
+    return mResult;
+}
+
+void LocalServer::sendTo(Unit::COLOR color, const QString &type, const QJsonValue &data)
+{
+    QJsonObject message;
+    message["type"] = type;
+    message["id"] = mNextId[color]++;
+    if(!data.isNull())message["data"] = data;
+    mQueue.push_back({true, color, message});
+}
+
+void LocalServer::handle(Unit::COLOR color, const QJsonObject &message)
+{
+    QString type = message["type"].toString();
+
+    if(type == "get_board"){
+        sendTo(color, "get_board", mField.toJson());
+    }else if(type == "is_ready"){
+        mReady[color] = true;
+        if(mReady[Unit::WHITE] && mReady[Unit::BLACK] && !mStarted){
+            mStarted = true;
+            startTurn();
+        }
+    }else if(color != mField.getId() || !mStarted){
+        return;//not this player's turn
+    }else if(type == "move" || type == "attack"){
+        QJsonObject data = message["data"].toObject();
+        Coordinates from(data["from"].toObject());
+        Coordinates to(data["to"].toObject());
+        if(!from.isValid() || !to.isValid()){
+            finish(color == Unit::WHITE ? BLACK_WINS : WHITE_WINS);
+            return;
+        }
+        mActions.push_back(std::make_shared<Action>(type == "move" ? Action::MOVE : Action::ATTACK, from, to));
+    }else if(type == "end_turn"){
+        endTurn(color);
+    }
+}
+
+void LocalServer::startTurn()
+{
+    if(mField.possibleTurns().empty()){
+        finish(DRAW);//the player can't play
+        return;
+    }
+    mActions.clear();
+    sendTo(static_cast<Unit::COLOR>(mField.getId()), "your_turn");
+}
+
+void LocalServer::endTurn(Unit::COLOR color)
+{
+    //a move, optionally followed by an attack from the destination of the move
+    bool wellFormed = (mActions.size() == 1 || mActions.size() == 2) && mActions[0]->getType() == Action::MOVE;
+    if(wellFormed && mActions.size() == 2){
+        wellFormed = mActions[1]->getType() == Action::ATTACK && mActions[1]->getFrom().index() == mActions[0]->getTo().index();
+    }
+
+    Turn turn;
+    if(wellFormed){
+        turn = mActions.size() == 1 ? Turn(mActions[0]) : Turn(mActions[0], mActions[1]);
+        quint32 packed = turn.pack();
+        wellFormed = false;
+        for(const Turn &possible : mField.possibleTurns()){
+            if(possible.pack() == packed){
+                wellFormed = true;
+                break;
+            }
+        }
+    }
+
+    Unit::COLOR opponent = color == Unit::WHITE ? Unit::BLACK : Unit::WHITE;
+    if(!wellFormed){
+        finish(color == Unit::WHITE ? BLACK_WINS : WHITE_WINS);//illegal turn
+        return;
+    }
+
+    for(const std::shared_ptr<Action> &action : mActions){
+        mField.applyAction(*action);
+        QJsonObject data = action->toJson()["data"].toObject();
+        for(Unit::COLOR client : {Unit::WHITE, Unit::BLACK}){
+            sendTo(client, action->getType() == Action::MOVE ? "move" : "attack", data);
+        }
+    }
+    mField.setId(opponent);
+    ++mTurns;
+
+    if(mField.numberOfMyUnits() == 0){
+        finish(color == Unit::WHITE ? WHITE_WINS : BLACK_WINS);
+    }else if(mTurns >= mMaxTurns){
+        finish(DRAW);
+    }else{
+        startTurn();
+    }
+}
+
+void LocalServer::finish(RESULT result)
+{
+    mResult = result;
+    if(result == DRAW)return;//no message for a draw
+
+    Unit::COLOR winner = result == WHITE_WINS ? Unit::WHITE : Unit::BLACK;
+    Unit::COLOR looser = result == WHITE_WINS ? Unit::BLACK : Unit::WHITE;
+    sendTo(winner, "you_win");
+    sendTo(looser, "you_loose");
+}
@@ -0,0 +1,185 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   localserver.hpp
+ * Author: azarias
+ *
+ * Created on 3/3/2018
+ */
+#ifndef LOCALSERVER_HPP
+#define LOCALSERVER_HPP
+
+#include <QJsonObject>
+#include <QString>
+
+#include <deque>
+#include <vector>
+
+#include "action.hpp"
+#include "battlefield.hpp"
+
+/**
+ * @brief The LocalServer class
+ * in-process stand-in for the Guerrilla server : plays one game
+ * between two clients with the same protocol (your_id, get_board,
+ * is_ready, your_turn, move, attack, end_turn, you_win, you_loose).
+ * The messages are queued and delivered one by one, so that a client
+ * never receives a message while it is sending its own
+ */
+class LocalServer
+{
+public:
+    /**
+     * @brief The RESULT enum result of the game
+     */
+    enum RESULT {PLAYING, WHITE_WINS, BLACK_WINS, DRAW};
+
+    /**
+     * @brief The Connection class a client of the server
+     */
+    class Connection
+    {
+    public:
+        virtual ~Connection(){}
+
+        /**
+         * @brief deliver gives a message of the server to the client
+         * @param message
+         */
+        virtual void deliver(const QString &message) = 0;
+    };
+
+    /**
+     * @brief LocalServer constructor
+     * @param start the units at the start of the game, the
+     * player of its id plays first
+     * @param maxTurns the game is a draw after this number of turns
+     */
+    LocalServer(const BattleField &start, int maxTurns);
+
+    /**
+     * @brief join connects the client playing the given color
+     * @param color
+     * @param connection must outlive the server
+     */
+    void join(Unit::COLOR color, Connection &connection);
+
+    /**
+     * @brief receive a message sent by a client
+     * (handled once the previous messages are delivered)
+     * @param color color of the client
+     * @param message
+     */
+    void receive(Unit::COLOR color, const QJsonObject &message);
+
+    /**
+     * @brief run plays the game until the end
+     * @return the result of the game
+     */
+    RESULT run();
+
+    /**
+     * @brief getTurns the number of turns played
+     * @return
+     */
+    int getTurns() const
+    {
+        return mTurns;
+    }
+
+private:
+    /**
+     * @brief The Message struct a message waiting in the queue
+     */
+    struct Message{
+        bool toClient;
+        Unit::COLOR color;
+        QJsonObject message;
+    };
+
+    /**
+     * @brief handle handles a message of a client
+     * @param color
+     * @param message
+     */
+    void handle(Unit::COLOR color, const QJsonObject &message);
+
+    /**
+     * @brief sendTo sends a message (with its id) to the given client
+     * @param color
+     * @param type
+     * @param data
+     */
+    void sendTo(Unit::COLOR color, const QString &type, const QJsonValue &data = QJsonValue());
+
+    /**
+     * @brief startTurn asks the player to move to play
+     */
+    void startTurn();
+
+    /**
+     * @brief endTurn checks and applies the turn of the player
+     * @param color
+     */
+    void endTurn(Unit::COLOR color);
+
+    /**
+     * @brief finish ends the game
+     * @param result
+     */
+    void finish(RESULT result);
+
+    /**
+     * @brief mField the battlefield of the server,
+     * its id is the color of the player to move
+     */
+    BattleField mField;
+
+    const int mMaxTurns;
+
+    Connection *mConnections[2] = {nullptr, nullptr};
+
+    /**
+     * @brief mNextId id of the next message to each client
+     */
+    int mNextId[2] = {0, 0};
+
+    bool mReady[2] = {false, false};
+
+    bool mStarted = false;
+
+    /**
+     * @brief mActions actions received during the current turn
+     */
+    std::vector<std::shared_ptr<Action>> mActions;
+
+    std::deque<Message> mQueue;
+
+    int mTurns = 0;
+
+    RESULT mResult = PLAYING;
+};
+
+#endif // LOCALSERVER_HPP
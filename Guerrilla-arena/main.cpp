@@ -0,0 +1,431 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   main.cpp
+ * Author: azarias
+ *
+ * Created on 3/3/2018
+ */
+#include <QString>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QFile>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "battlefield.hpp"
+#include "gamesession.hpp"
+#include "localserver.hpp"
+#include "metricsserver.hpp"
+#include "trace.hpp"
+
+namespace {
+
+/**
+ * @brief The PlayerSettings struct how an engine is configured
+ */
+struct PlayerSettings{
+    /**
+     * @brief depth forced depth of the search (0 : depending on the units)
+     */
+    std::size_t depth = 0;
+
+    /**
+     * @brief options selective search and limits
+     */
+    SearchOptions options;
+
+    /**
+     * @brief data directory of the opening book, tablebases, weights and network (none if empty)
+     */
+    QString data;
+};
+
+/**
+ * @brief The Results struct results of the games of engine A
+ */
+struct Results{
+    int wins = 0;
+
+    int draws = 0;
+
+    int losses = 0;
+
+    long turns = 0;
+
+    /**
+     * @brief times time of each turn of each engine, in microseconds
+     */
+    std::vector<qint64> times[2];
+
+    /**
+     * @brief stops number of searches of each engine stopped for each reason
+     */
+    std::array<long, 4> stops[2] = {};
+
+    void merge(const Results &other)
+    {
+        wins += other.wins;
+        draws += other.draws;
+        losses += other.losses;
+        turns += other.turns;
+        for(int i = 0; i < 2; ++i){
+            times[i].insert(times[i].end(), other.times[i].begin(), other.times[i].end());
+            for(std::size_t stop = 0; stop < stops[i].size(); ++stop)stops[i][stop] += other.stops[i][stop];
+        }
+    }
+};
+
+/**
+ * @brief The ArenaPlayer class an engine connected to the local server
+ */
+class ArenaPlayer : public LocalServer::Connection, public GameSession::Listener
+{
+public:
+    ArenaPlayer(LocalServer &server, Unit::COLOR color, const PlayerSettings &settings, std::vector<qint64> &times,
+                std::array<long, 4> &stops, const QString &recordPath, MetricsRegistry *metrics, const QString &name):
+        mServer(server),
+        mColor(color),
+        mTimes(times),
+        mStops(stops),
+        mSession(*this)
+    {
+        mSession.getEngine().setDepth(settings.depth);
+        mSession.getEngine().setOptions(settings.options);
+        if(!settings.data.isEmpty()){
+            mSession.getEngine().loadOpeningBook(settings.data + "/opening.book");
+            mSession.getEngine().loadTablebases(settings.data + "/tablebases");
+            mSession.getEngine().loadWeights(settings.data + "/weights.json");
+            mSession.getEngine().loadNetwork(settings.data + "/network.nnue");
+        }
+        if(!recordPath.isEmpty() && !mSession.getRecorder().open(recordPath)){
+            qWarning() << "Could not open the game record" << recordPath;
+        }
+        if(metrics)mSession.setMetrics(metrics, name);
+        server.join(color, *this);
+        mSession.start();//connected
+    }
+
+    void deliver(const QString &message) override
+    {
+        mSession.messageReceived(message);
+    }
+
+    void send(const QJsonObject &message) override
+    {
+        mServer.receive(mColor, message);
+    }
+
+    void turnChosen(const Turn &turn, const Engine::Decision &decision) override
+    {
+        Q_UNUSED(turn);
+        mTimes.push_back(decision.time);
+        if(decision.source == Engine::SEARCH)++mStops[decision.stop];
+    }
+
+private:
+    LocalServer &mServer;
+
+    Unit::COLOR mColor;
+
+    std::vector<qint64> &mTimes;
+
+    std::array<long, 4> &mStops;
+
+    GameSession mSession;
+};
+
+/**
+ * @brief startPosition the start of a game : the deployment, then
+ * a few random turns (the same for both games of a pair)
+ * @param deployment
+ * @param seed
+ * @param randomTurns
+ * @return
+ */
+BattleField startPosition(const QJsonArray &deployment, unsigned seed, int randomTurns)
+{
+    BattleField field;
+    field.setId(Unit::WHITE);
+    field.fillField(deployment);
+
+    std::mt19937 random(seed);
+    for(int i = 0; i < randomTurns; ++i){
+        std::vector<Turn> turns = field.possibleTurns();
+        if(turns.empty())break;
+        turns[random() % turns.size()].applyActions(field);
+        field.setId(1 - field.getId());
+        if(field.numberOfMyUnits() == 0)break;
+    }
+    return field;
+}
+
+/**
+ * @brief percentile
+ * @param values sorted values
+ * @param p
+ * @return
+ */
+double percentile(const std::vector<qint64> &values, double p)
+{
+    if(values.empty())return 0.;
+    return values[std::min(values.size() - 1, std::size_t(p * values.size()))];
+}
+
+/**
+ * @brief elo elo difference corresponding to the given score
+ * @param score
+ * @return
+ */
+double elo(double score)
+{
+    score = std::min(std::max(score, 0.001), 0.999);
+    return -400. * std::log10(1. / score - 1.);
+}
+
+bool readSettings(const QString &option, const QString &value, PlayerSettings settings[2])
+{
+    for(int player = 0; player < 2; ++player){
+        QString prefix = player ? "--b-" : "--a-";
+        if(option == prefix + "depth"){
+            settings[player].depth = value.toInt();
+            return true;
+        }else if(option == prefix + "data"){
+            settings[player].data = value;
+            return true;
+        }else if(option == prefix + "time"){
+            settings[player].options.timeLimit = value.toInt();
+            return true;
+        }else if(option == prefix + "nodes"){
+            settings[player].options.nodeLimit = value.toLongLong();
+            return true;
+        }else if(option == prefix + "memory"){
+            settings[player].options.memoryLimit = value.toLongLong() * 1024;
+            return true;
+        }else if(option == prefix + "search"){
+            SearchOptions &options = settings[player].options;
+            options.nullMove = value == "all" || value.contains("null");
+            options.lateMoveReductions = value == "all" || value.contains("lmr");
+            options.futility = value == "all" || value.contains("futility");
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+/**
+ * @brief main plays games between two engines (A and B) on a
+ * local stand-in server, on all the cores
+ * usage : Guerrilla-arena [options] <deployment.json>...
+ *   --games <n>         number of games (100), played by pairs : the same
+ *                       start with the colors swapped
+ *   --threads <n>       number of games played at the same time (all the cores)
+ *   --random-turns <n>  random turns played from the deployment (4)
+ *   --max-turns <n>     the game is a draw after this number of turns (200)
+ *   --a-depth <n>, --b-depth <n>  forced depth of the search of A, B
+ *   --a-time <ms>, --b-time <ms>  time limit of the search of A, B
+ *   --a-nodes <n>, --b-nodes <n>  node limit of the search of A, B
+ *   --a-memory <kb>, --b-memory <kb>  memory limit of the search of A, B
+ *   --a-search <list>, --b-search <list>  selective search of A, B : all (default), none,
+ *                       or some of null,lmr,futility
+ *   --a-data <dir>, --b-data <dir>  directory with the opening book, tablebases,
+ *                       evaluation weights and network of A, B
+ *   --records <dir>     records the games of both engines in the given directory
+ *   --trace <file>      writes the trace events of the games (tracing builds only)
+ *   --metrics <port>    serves the metrics of the games being played on
+ *                       http://localhost:<port>/metrics
+ * the deployments use the same format as the get_board message
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main(int argc, char *argv[])
+{
+    int games = 100;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int randomTurns = 4;
+    int maxTurns = 200;
+    PlayerSettings settings[2];
+    std::vector<QJsonArray> deployments;
+    QString tracePath;
+    QString recordsDir;
+    int metricsPort = 0;
+
+    for(int i = 1; i < argc; ++i){
+        QString arg = argv[i];
+        if(arg.startsWith("--")){
+            if(i + 1 >= argc){
+                qDebug() << "Missing value for" << arg;
+                return 1;
+            }
+            QString value = argv[++i];
+            if(arg == "--games")games = value.toInt();
+            else if(arg == "--threads")threads = std::max(1, value.toInt());
+            else if(arg == "--random-turns")randomTurns = value.toInt();
+            else if(arg == "--max-turns")maxTurns = value.toInt();
+            else if(arg == "--trace")tracePath = value;
+            else if(arg == "--records")recordsDir = value;
+            else if(arg == "--metrics")metricsPort = value.toInt();
+            else if(!readSettings(arg, value, settings)){
+                qDebug() << "Unknown option" << arg;
+                return 1;
+            }
+            continue;
+        }
+
+        QFile f(arg);
+        if(!f.open(QIODevice::ReadOnly | QIODevice::Text)){
+            qDebug() << "Failed to open file" << arg;
+            return 1;
+        }
+        QJsonDocument doc = QJsonDocument::fromJson(f.readAll());
+        if(doc.isNull()){
+            qDebug() << "Failed to parse json" << arg;
+            return 1;
+        }
+        deployments.push_back(doc.object().value("data").toArray());
+    }
+
+    if(deployments.empty() || games < 1){
+        qDebug() << "Usage :" << argv[0] << "[--games n] [--threads n] [--random-turns n] [--max-turns n]"
+                 << "[--a-depth n] [--b-depth n] [--a-time ms] [--b-time ms] [--a-nodes n] [--b-nodes n] [--a-memory kb] [--b-memory kb] [--a-search list] [--b-search list] [--a-data dir] [--b-data dir] [--records dir] [--trace file] [--metrics port] <deployment.json>...";
+        return 1;
+    }
+
+    if(!recordsDir.isEmpty() && !QDir().mkpath(recordsDir)){
+        qDebug() << "Could not create the records directory" << recordsDir;
+        return 1;
+    }
+
+    if(!tracePath.isEmpty() && !Trace::start(tracePath)){
+        qDebug() << "Tracing is not compiled in (qmake CONFIG+=tracing)";
+        return 1;
+    }
+
+    //the metrics server has its own thread, the games don't wait for it
+    MetricsRegistry metrics;
+    std::unique_ptr<QCoreApplication> application;
+    std::unique_ptr<MetricsServer> metricsServer;
+    if(metricsPort > 0){
+        application.reset(new QCoreApplication(argc, argv));
+        metricsServer.reset(new MetricsServer(metrics, quint16(metricsPort)));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    std::atomic<int> nextGame(0);
+    std::atomic<int> nextWorker(0);
+    std::mutex mutex;
+    Results total;
+
+    auto worker = [&](){
+        Trace::setThreadName(QString("worker %1").arg(nextWorker++));
+        Results results;
+        for(int game = nextGame++; game < games; game = nextGame++){
+            int pair = game / 2;
+            Unit::COLOR colorA = game % 2 ? Unit::BLACK : Unit::WHITE;
+            Unit::COLOR colorB = colorA == Unit::WHITE ? Unit::BLACK : Unit::WHITE;
+
+            BattleField start = startPosition(deployments[pair % deployments.size()], pair, randomTurns);
+            if(start.numberOfMyUnits() == 0)continue;
+
+            LocalServer server(start, maxTurns);
+            auto record = [&](const QString &player){
+                return recordsDir.isEmpty() ? QString() : QString("%1/game-%2-%3.grec").arg(recordsDir).arg(game).arg(player);
+            };
+            MetricsRegistry *registry = metricsPort > 0 ? &metrics : nullptr;
+            ArenaPlayer a(server, colorA, settings[0], results.times[0], results.stops[0], record("a"),
+                          registry, QString("game-%1-a").arg(game));
+            ArenaPlayer b(server, colorB, settings[1], results.times[1], results.stops[1], record("b"),
+                          registry, QString("game-%1-b").arg(game));
+
+            LocalServer::RESULT result = server.run();
+            results.turns += server.getTurns();
+            if(result == LocalServer::DRAW)++results.draws;
+            else if((result == LocalServer::WHITE_WINS) == (colorA == Unit::WHITE))++results.wins;
+            else ++results.losses;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        total.merge(results);
+    };
+
+    std::vector<std::thread> pool;
+    for(int i = 0; i < threads; ++i)pool.emplace_back(worker);
+    for(std::thread &thread : pool)thread.join();
+
+    if(!tracePath.isEmpty() && !Trace::stop())qDebug() << "Could not write the trace" << tracePath;
+
+    int played = total.wins + total.draws + total.losses;
+    if(!played){
+        qDebug() << "No game played";
+        return 1;
+    }
+
+    // score of A, with a 95% confidence interval (normal approximation)
+    double score = (total.wins + 0.5 * total.draws) / played;
+    double variance = (total.wins * std::pow(1. - score, 2) + total.draws * std::pow(0.5 - score, 2) +
+                       total.losses * std::pow(score, 2)) / played;
+    double margin = 1.96 * std::sqrt(variance / played);
+
+    qDebug().noquote() << QString("%1 games in %2s (%3 threads), %4 turns per game")
+                          .arg(played).arg(timer.elapsed() / 1000.).arg(threads).arg(double(total.turns) / played);
+    qDebug().noquote() << QString("A : %1 wins, %2 draws, %3 losses").arg(total.wins).arg(total.draws).arg(total.losses);
+    qDebug().noquote() << QString("Score of A : %1% +- %2% (95%)").arg(100. * score).arg(100. * margin);
+    qDebug().noquote() << QString("Elo difference : %1 [%2, %3]").arg(elo(score)).arg(elo(score - margin)).arg(elo(score + margin));
+
+    for(int player = 0; player < 2; ++player){
+        std::vector<qint64> &times = total.times[player];
+        std::sort(times.begin(), times.end());
+        double mean = 0.;
+        for(qint64 time : times)mean += time;
+        if(!times.empty())mean /= times.size();
+
+        qDebug().noquote() << QString("Time per turn of %1 : mean %2ms, median %3ms, 95th percentile %4ms, max %5ms")
+                              .arg(player ? "B" : "A").arg(mean / 1000.).arg(percentile(times, 0.5) / 1000.)
+                              .arg(percentile(times, 0.95) / 1000.).arg(times.empty() ? 0. : times.back() / 1000.);
+
+        const std::array<long, 4> &stops = total.stops[player];
+        qDebug().noquote() << QString("Searches of %1 stopped by : depth %2, time %3, nodes %4, memory %5")
+                              .arg(player ? "B" : "A").arg(qint64(stops[SearchOptions::DEPTH])).arg(qint64(stops[SearchOptions::TIME]))
+                              .arg(qint64(stops[SearchOptions::NODES])).arg(qint64(stops[SearchOptions::MEMORY]));
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+#-------------------------------------------------
+#
+# Opening book generator : searches the first turns
+# of the given deployments and writes the book file
+# loaded by the client (opening.book)
+#
+#-------------------------------------------------
+
+QT       += websockets
+
+QT       -= gui
+
+INCLUDEPATH += ".."
+
+TARGET = Guerrilla-book
+CONFIG   += console c++14
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+include(../geometry.pri)
+include(../trace.pri)
+include(../simd.pri)
+include(../sharedmemory.pri)
+
+SOURCES += \
+        main.cpp  \
+        ..\battlefield.cpp \
+        ..\unit.cpp \
+        ..\action.cpp \
+        ..\tree.cpp \
+        ..\zobrist.cpp \
+        ..\openingbook.cpp \
+        ..\tablebase.cpp \
+        ..\transpositiontable.cpp \
+        ..\targets.cpp \
+        ..\searchstats.cpp \
+        ..\trace.cpp \
+        ..\evaluation.cpp \
+        ..\movegenerator.cpp \
+        ..\network.cpp
+
+HEADERS += \
+    ..\battlefield.hpp \
+    ..\unit.hpp \
+    ..\action.hpp \
+    ..\coordinates.hpp \
+    ..\tree.hpp \
+    ..\zobrist.hpp \
+    ..\openingbook.hpp \
+    ..\tablebase.hpp \
+    ..\transpositiontable.hpp \
+    ..\searchcache.hpp \
+    ..\targets.hpp \
+    ..\geometry.hpp \
+    ..\searchstats.hpp \
+    ..\trace.hpp \
+    ..\evaluation.hpp \
+    ..\searchoptions.hpp \
+    ..\movegenerator.hpp \
+    ..\network.hpp \
+    ..\symmetry.hpp
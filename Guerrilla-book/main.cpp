@@ -0,0 +1,126 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   main.cpp
+ * Author: azarias
+ *
+ * Created on 20/2/2018
+ */
+#include <QString>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QFile>
+#include <QDebug>
+
+#include "tree.hpp"
+#include "battlefield.hpp"
+#include "openingbook.hpp"
+
+/**
+ * @brief bookLine searches the best turn of each position
+ * of the line starting at the given deployment, the
+ * best turn is then played, and the other player searches
+ * @param field the deployment
+ * @param depth depth of the search
+ * @param plies number of turns of the line
+ * @param evaluation evaluation of the search
+ * @param entries the book entries found
+ */
+void bookLine(BattleField field, std::size_t depth, int plies, const Evaluation &evaluation, std::vector<OpeningBook::Entry> &entries)
+{
+    SearchCache cache;//kept along the line, as during a game
+    for(int ply = 0; ply < plies && !field.possibleTurns().empty(); ++ply){
+        Tree tree(cache);
+        tree.setEvaluation(&evaluation);
+        tree.generate(depth, field);
+        Turn best = tree.getBestAction();
+
+        OpeningBook::Entry entry = {};
+        int symmetry;
+        entry.hash = field.canonicalHash(symmetry);
+        entry.turn = Symmetry::turn(symmetry, best.pack());
+        entry.depth = depth;
+        entries.push_back(entry);
+
+        best.applyActions(field);
+        field.setId(1 - field.getId());
+    }
+}
+
+/**
+ * @brief main generates an opening book
+ * usage : Guerrilla-book <output> <depth> <plies> <deployment.json>...
+ * the deployments use the same format as the get_board message,
+ * the evaluation weights and network of the working directory are used (if any)
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main(int argc, char *argv[])
+{
+    if(argc < 5){
+        qDebug() << "Usage :" << argv[0] << "<output> <depth> <plies> <deployment.json>...";
+        return 1;
+    }
+
+    std::size_t depth = QString(argv[2]).toInt();
+    int plies = QString(argv[3]).toInt();
+
+    std::vector<OpeningBook::Entry> entries;
+
+    Evaluation evaluation;
+    if(evaluation.load("weights.json"))qDebug() << "Evaluation weights loaded";
+    if(evaluation.loadNetwork("network.nnue"))qDebug() << "Evaluation network loaded";
+
+    for(int i = 4; i < argc; ++i){
+        QFile f(argv[i]);
+        if(!f.open(QIODevice::ReadOnly | QIODevice::Text)){
+            qDebug() << "Failed to open file" << argv[i];
+            return 1;
+        }
+
+        QJsonDocument doc = QJsonDocument::fromJson(f.readAll());
+        if(doc.isNull()){
+            qDebug() << "Failed to parse json" << argv[i];
+            return 1;
+        }
+
+        //both players may start the game
+        for(int firstPlayer : {Unit::WHITE, Unit::BLACK}){
+            BattleField field;
+            field.setId(firstPlayer);
+            field.fillField(doc.object().value("data").toArray());
+            bookLine(field, depth, plies, evaluation, entries);
+        }
+        qDebug() << argv[i] << ":" << entries.size() << "positions";
+    }
+
+    if(!OpeningBook::write(argv[1], entries)){
+        qDebug() << "Failed to write the book" << argv[1];
+        return 1;
+    }
+
+    return 0;
+}
@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT  += core gui websockets
+QT  += core gui network websockets
 CONFIG += c++14
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
@@ -18,13 +18,36 @@ TEMPLATE = app
 # deprecated API in order to know how to port your code away from it.
 DEFINES += QT_DEPRECATED_WARNINGS
 
+include(geometry.pri)
+include(trace.pri)
+include(simd.pri)
+include(sharedmemory.pri)
+
 SOURCES += \
         main.cpp \
         MainWindow.cpp \
     battlefield.cpp \
     unit.cpp \
     action.cpp \
-    tree.cpp
+    tree.cpp \
+    zobrist.cpp \
+    openingbook.cpp \
+    tablebase.cpp \
+    transpositiontable.cpp \
+    engine.cpp \
+    targets.cpp \
+    BoardWidget.cpp \
+    gamerecord.cpp \
+    gamesession.cpp \
+    searchstats.cpp \
+    trace.cpp \
+    evaluation.cpp \
+    movegenerator.cpp \
+    network.cpp \
+    latency.cpp \
+    metrics.cpp \
+    metricsserver.cpp \
+    boardsync.cpp
 
 HEADERS += \
         MainWindow.hpp \
@@ -32,4 +55,26 @@ HEADERS += \
     unit.hpp \
     action.hpp \
     coordinates.hpp \
-    tree.hpp
+    tree.hpp \
+    zobrist.hpp \
+    openingbook.hpp \
+    tablebase.hpp \
+    transpositiontable.hpp \
+    engine.hpp \
+    searchcache.hpp \
+    targets.hpp \
+    geometry.hpp \
+    BoardWidget.hpp \
+    gamerecord.hpp \
+    gamesession.hpp \
+    searchstats.hpp \
+    trace.hpp \
+    evaluation.hpp \
+    searchoptions.hpp \
+    movegenerator.hpp \
+    network.hpp \
+    latency.hpp \
+    metrics.hpp \
+    metricsserver.hpp \
+    symmetry.hpp \
+    boardsync.hpp
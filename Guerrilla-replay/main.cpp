@@ -0,0 +1,156 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   main.cpp
+ * Author: azarias
+ *
+ * Created on 2/3/2018
+ */
+#include <QString>
+#include <QJsonArray>
+#include <QDebug>
+
+#include "battlefield.hpp"
+#include "engine.hpp"
+#include "gamerecord.hpp"
+
+namespace {
+
+const char *sourceNames[] = {"none", "tablebase", "book", "search"};
+
+/**
+ * @brief turnString
+ * @param packed a packed turn
+ * @return the turn, readable
+ */
+QString turnString(quint32 packed)
+{
+    if(!packed)return "(none)";
+
+    Turn turn = Turn::unpack(packed);
+    QString res;
+    for(quint8 i = 0; i < 2; ++i){
+        const std::shared_ptr<Action> &action = turn.getAction(i);
+        if(!action)continue;
+        res += QString("%1(%2,%3)->(%4,%5)").arg(i ? " attack " : "move ")
+                .arg(action->getFrom().x).arg(action->getFrom().y)
+                .arg(action->getTo().x).arg(action->getTo().y);
+    }
+    return res;
+}
+
+/**
+ * @brief The Totals struct what the replay of the records found
+ */
+struct Totals{
+    int decisions = 0;
+
+    int sameTurns = 0;
+
+    int skipped = 0;
+
+    qint64 recordedTime = 0;
+
+    qint64 replayedTime = 0;
+};
+
+/**
+ * @brief replay searches again the positions
+ * where the client played (see GameRecordReader::getField)
+ * @param path
+ * @param totals
+ * @return wether the record could be read
+ */
+bool replay(const QString &path, Totals &totals)
+{
+    GameRecordReader reader;
+    if(!reader.open(path)){
+        qDebug() << "Invalid game record" << path;
+        return false;
+    }
+
+    Engine engine;
+    engine.loadOpeningBook("opening.book");
+    engine.loadTablebases("tablebases");
+    engine.loadWeights("weights.json");
+    engine.loadNetwork("network.nnue");
+
+    GameRecord::Entry entry;
+    while(reader.next(entry)){
+        if(entry.kind != GameRecord::DECISION)continue;
+
+        const BattleField &field = reader.getField();
+        if(entry.hash != field.hash()){
+            qDebug() << path << ": the position does not match the record, decision skipped";
+            ++totals.skipped;
+            continue;
+        }
+
+        Turn turn = engine.play(field);
+        const Engine::Decision &decision = engine.lastDecision();
+        bool same = turn.pack() == entry.turn;
+
+        ++totals.decisions;
+        totals.sameTurns += same;
+        totals.recordedTime += entry.decision.time;
+        totals.replayedTime += decision.time;
+
+        qDebug().noquote() << QString("%1s").arg(entry.time / 1000.0)
+                           << "recorded" << turnString(entry.turn) << sourceNames[entry.decision.source]
+                           << "score" << entry.decision.score << "depth" << entry.decision.depth << entry.decision.time << "us |"
+                           << "replayed" << (same ? QString("same") : turnString(turn.pack())) << sourceNames[decision.source]
+                           << "score" << decision.score << "depth" << decision.depth << decision.time << "us";
+    }
+    return true;
+}
+
+}
+
+/**
+ * @brief main replays game records recorded by the client
+ * usage : Guerrilla-replay <record>...
+ * each position where the client played is searched again
+ * (with the opening book, tablebases and weights of the working directory),
+ * the turns and times are compared to the recorded ones
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main(int argc, char *argv[])
+{
+    if(argc < 2){
+        qDebug() << "Usage :" << argv[0] << "<record>...";
+        return 1;
+    }
+
+    Totals totals;
+    for(int i = 1; i < argc; ++i){
+        if(!replay(argv[i], totals))return 1;
+    }
+
+    qDebug() << totals.decisions << "positions," << totals.sameTurns << "same turns," << totals.skipped << "skipped";
+    qDebug() << "Recorded time" << totals.recordedTime << "us, replayed time" << totals.replayedTime << "us";
+    return 0;
+}
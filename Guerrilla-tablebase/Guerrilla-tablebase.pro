@@ -0,0 +1,49 @@
+#-------------------------------------------------
+#
+# Tablebase generator : retrograde analysis of the
+# endgames with few units, writes the files loaded
+# by the client (from the tablebases directory)
+#
+#-------------------------------------------------
+
+QT       += websockets
+
+QT       -= gui
+
+INCLUDEPATH += ".."
+
+TARGET = Guerrilla-tablebase
+CONFIG   += console c++14
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+include(../geometry.pri)
+include(../trace.pri)
+include(../simd.pri)
+include(../sharedmemory.pri)
+
+SOURCES += \
+        main.cpp  \
+        ..\battlefield.cpp \
+        ..\unit.cpp \
+        ..\action.cpp \
+        ..\zobrist.cpp \
+        ..\tablebase.cpp \
+        ..\targets.cpp \
+        ..\trace.cpp \
+        ..\network.cpp
+
+HEADERS += \
+    ..\battlefield.hpp \
+    ..\unit.hpp \
+    ..\action.hpp \
+    ..\coordinates.hpp \
+    ..\zobrist.hpp \
+    ..\tablebase.hpp \
+    ..\targets.hpp \
+    ..\geometry.hpp \
+    ..\trace.hpp \
+    ..\network.hpp \
+    ..\symmetry.hpp
@@ -0,0 +1,380 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   main.cpp
+ * Author: azarias
+ *
+ * Created on 22/2/2018
+ */
+#include <QString>
+#include <QDebug>
+#include <algorithm>
+#include <map>
+
+#include "tablebase.hpp"
+
+typedef Tablebase::Material Material;
+
+/**
+ * @brief The Generator class
+ * generates the tables with a retrograde analysis.
+ * A table is generated together with its flipped table
+ * (same units, the opponent plays) since the turns of one
+ * lead to the positions of the other. The turns that kill
+ * a unit lead to smaller tables, generated before.
+ *
+ * During the generation, the tables are indexed by the fields
+ * of the units without any symmetry (white always plays)
+ */
+class Generator
+{
+public:
+    Generator(const QString &directory):
+        mDirectory(directory)
+    {
+    }
+
+    /**
+     * @brief generate generates (and writes) the table of the given material,
+     * its flipped table and all the smaller tables they need
+     * @param material
+     */
+    void generate(const Material &material);
+
+private:
+    /**
+     * @brief The Work struct
+     * state of a table being generated
+     */
+    struct Work{
+        Material material;
+
+        /**
+         * @brief value value of each position, 0 until it is known
+         */
+        std::vector<qint8> value;
+
+        /**
+         * @brief pending number of turns (that do not kill) of each position
+         * whose result is not known yet, 255 when the position can't be lost
+         * (or is not valid)
+         */
+        std::vector<quint8> pending;
+
+        /**
+         * @brief worst longest win of the opponent found
+         * among the known turns
+         */
+        std::vector<quint8> worst;
+    };
+
+    static const int maxDistance = 127;
+
+    static const quint8 neverLost = 255;
+
+    /**
+     * @brief decode the fields of the units of a position
+     */
+    static void decode(quint64 index, int count, int *squares);
+
+    static quint64 encode(const int *squares, int count);
+
+    /**
+     * @brief flippedIndex index of the position once the colors
+     * are swapped and the board flipped : the units of the
+     * "other" player become the first ones
+     * @param squares
+     * @param moverCount
+     * @param count
+     * @return
+     */
+    static quint64 flippedIndex(const int *squares, int moverCount, int count);
+
+    /**
+     * @brief initialize computes the turns of every position of
+     * the table, the turns killing a unit are looked up in
+     * the smaller tables
+     * @param work
+     * @return the greatest distance found
+     */
+    int initialize(Work &work);
+
+    /**
+     * @brief retrograde propagates the results of the positions at the given
+     * distance to the positions that lead to them
+     * @param works the table and its flipped table (if different)
+     * @param distance
+     * @return the greatest distance found
+     */
+    int retrograde(std::vector<Work> &works, int distance);
+
+    QString mDirectory;
+
+    /**
+     * @brief mTables the tables already generated
+     */
+    std::map<QString, std::vector<qint8>> mTables;
+};
+
+void Generator::decode(quint64 index, int count, int *squares)
+{
+    for(int i = count - 1; i >= 0; --i){
+        squares[i] = index % Geometry::SIZE;
+        index /= Geometry::SIZE;
+    }
+}
+
+quint64 Generator::encode(const int *squares, int count)
+{
+    quint64 index = 0;
+    for(int i = 0; i < count; ++i)index = index * Geometry::SIZE + squares[i];
+    return index;
+}
+
+quint64 Generator::flippedIndex(const int *squares, int moverCount, int count)
+{
+    int flipped[Tablebase::maxGeneratedUnits];
+    int n = 0;
+    for(int i = moverCount; i < count; ++i)flipped[n++] = squares[i];
+    for(int i = 0; i < moverCount; ++i)flipped[n++] = squares[i];
+    for(int i = 0; i < count; ++i)flipped[i] = (Geometry::HEIGHT - 1 - flipped[i] / Geometry::WIDTH) * Geometry::WIDTH + flipped[i] % Geometry::WIDTH;
+    return encode(flipped, count);
+}
+
+void Generator::generate(const Material &material)
+{
+    if(mTables.count(material.name()))return;
+
+    std::vector<Work> works(1);
+    works[0].material = material;
+    if(material.flipped().name() != material.name()){
+        works.resize(2);
+        works[1].material = material.flipped();
+    }
+
+    //killing a unit leads to a smaller table, where the opponent plays
+    for(const Work &work : works){
+        for(std::size_t i = 0; i < work.material.other.size() && work.material.other.size() > 1; ++i){
+            Material smaller = work.material;
+            smaller.other.erase(smaller.other.begin() + i);
+            generate(smaller.flipped());
+        }
+    }
+
+    qDebug() << "Generating" << material.name();
+
+    int maxFound = 0;
+    for(Work &work : works){
+        quint64 size = Tablebase::fullSize(work.material);
+        work.value.assign(size, 0);
+        work.pending.assign(size, 0);
+        work.worst.assign(size, 0);
+        maxFound = std::max(maxFound, initialize(work));
+    }
+
+    for(int distance = 1; distance <= maxFound && distance <= maxDistance; ++distance){
+        maxFound = std::max(maxFound, retrograde(works, distance));
+    }
+
+    for(Work &work : works){
+        QString path = mDirectory + "/" + Tablebase::fileName(work.material);
+        if(!Tablebase::write(path, work.material, work.value)){
+            qWarning() << "Failed to write" << path;
+        }
+        mTables[work.material.name()] = std::move(work.value);
+    }
+}
+
+int Generator::initialize(Work &work)
+{
+    const Material &material = work.material;
+    const int moverCount = material.mover.size();
+    const int count = material.size();
+
+    //smaller tables, when the ith unit of the opponent is killed
+    std::vector<const std::vector<qint8>*> smaller(count, nullptr);
+    for(int i = moverCount; i < count && count - moverCount > 1; ++i){
+        Material killed = material;
+        killed.other.erase(killed.other.begin() + (i - moverCount));
+        smaller[i] = &mTables[killed.flipped().name()];
+    }
+
+    int maxFound = 0;
+    int squares[Tablebase::maxGeneratedUnits];
+    int child[Tablebase::maxGeneratedUnits];
+
+    for(quint64 index = 0; index < work.value.size(); ++index){
+        decode(index, count, squares);
+
+        auto occupant = [&](int square){
+            for(int i = 0; i < count; ++i)if(squares[i] == square)return i;
+            return -1;
+        };
+
+        bool valid = true;
+        for(int i = 0; i < count && valid; ++i)valid = occupant(squares[i]) == i;
+        if(!valid){
+            work.pending[index] = neverLost;
+            continue;
+        }
+
+        int moves = 0;
+        int bestWin = maxDistance + 1;
+        int worst = 0;
+        bool drawn = false;
+
+        for(int i = 0; i < moverCount; ++i){
+            Coordinates from = Coordinates::fromIndex(squares[i]);
+            for(const Coordinates &move : Unit::movesOf(material.mover[i])){
+                Coordinates to = from + move;
+                if(!to.isValid() || occupant(to.index()) != -1)continue;
+                ++moves;
+
+                for(const Coordinates &attack : Unit::attacksOf(material.mover[i], Unit::WHITE)){
+                    Coordinates target = to + attack;
+                    if(!target.isValid())continue;
+                    int killed = occupant(target.index());
+                    if(killed < moverCount)continue;//empty, or one of ours
+
+                    if(!smaller[killed]){
+                        bestWin = 1;//last unit of the opponent
+                        continue;
+                    }
+
+                    int n = 0;
+                    for(int j = 0; j < count; ++j){
+                        if(j != killed)child[n++] = j == i ? to.index() : squares[j];
+                    }
+                    int value = (*smaller[killed])[flippedIndex(child, moverCount, count - 1)];
+                    if(value < 0)bestWin = std::min(bestWin, 1 - value);
+                    else if(value == 0)drawn = true;
+                    else worst = std::max(worst, value);
+                }
+            }
+        }
+
+        if(bestWin <= maxDistance){
+            work.value[index] = bestWin;
+            maxFound = std::max(maxFound, bestWin);
+        }
+
+        if(drawn || moves == 0){
+            work.pending[index] = neverLost;//a unit that can't move is considered a draw
+        }else{
+            work.pending[index] = moves;
+            work.worst[index] = worst;
+        }
+    }
+    return maxFound;
+}
+
+int Generator::retrograde(std::vector<Work> &works, int distance)
+{
+    int maxFound = 0;
+    int squares[Tablebase::maxGeneratedUnits];
+
+    for(std::size_t t = 0; t < works.size(); ++t){
+        const Work &work = works[t];
+        Work &previous = works[(t + 1) % works.size()];
+        const Material &material = work.material;
+        const int moverCount = material.mover.size();
+        const int count = material.size();
+
+        for(quint64 index = 0; index < work.value.size(); ++index){
+            int value = work.value[index];
+            if(value != distance && value != -distance)continue;
+
+            decode(index, count, squares);
+
+            //the opponent of the player that has to play just moved one of its units
+            for(int i = moverCount; i < count; ++i){
+                int square = squares[i];
+                Coordinates to = Coordinates::fromIndex(square);
+                for(const Coordinates &move : Unit::movesOf(material.other[i - moverCount])){
+                    Coordinates from(to.x - move.x, to.y - move.y);
+                    if(!from.isValid() || std::find(squares, squares + count, from.index()) != squares + count)continue;
+
+                    squares[i] = from.index();
+                    quint64 prev = flippedIndex(squares, moverCount, count);
+                    squares[i] = square;
+
+                    qint8 &prevValue = previous.value[prev];
+                    if(value < 0){
+                        //the previous player can move to a lost position
+                        if(prevValue == 0 && distance < maxDistance){
+                            prevValue = distance + 1;
+                            maxFound = std::max(maxFound, distance + 1);
+                        }else if(prevValue > distance + 1){
+                            prevValue = distance + 1;
+                        }
+                    }else if(prevValue == 0 && previous.pending[prev] != neverLost){
+                        quint8 &worst = previous.worst[prev];
+                        worst = std::max<int>(worst, distance);
+                        if(--previous.pending[prev] == 0 && worst < maxDistance){
+                            //all the turns lead to lost positions
+                            prevValue = -(worst + 1);
+                            maxFound = std::max(maxFound, worst + 1);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return maxFound;
+}
+
+/**
+ * @brief main generates tablebases
+ * usage : Guerrilla-tablebase <output directory> <material>...
+ * a material is written as the units of both players, e.g. "LvR" or "SLvR"
+ * (S : mobile tower, L : infantery, R : gunner)
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main(int argc, char *argv[])
+{
+    if(argc < 3){
+        qDebug() << "Usage :" << argv[0] << "<output directory> <material>...";
+        return 1;
+    }
+
+    Generator generator(argv[1]);
+
+    for(int i = 2; i < argc; ++i){
+        Material material;
+        if(!Material::fromName(argv[i], material)){
+            qDebug() << "Invalid material" << argv[i];
+            return 1;
+        }
+        if(material.size() > Tablebase::maxGeneratedUnits){
+            qDebug() << "Too many units" << argv[i];
+            return 1;
+        }
+        generator.generate(material);
+    }
+
+    return 0;
+}
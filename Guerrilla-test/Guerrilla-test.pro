@@ -17,19 +17,56 @@ CONFIG   -= app_bundle
 TEMPLATE = app
 
 
+include(../geometry.pri)
+include(../trace.pri)
+include(../simd.pri)
+include(../sharedmemory.pri)
+
 SOURCES += \
         tst_MainTest.cpp  \
         ..\battlefield.cpp \
         ..\unit.cpp \
         ..\action.cpp \
-        ..\tree.cpp
+        ..\tree.cpp \
+        ..\zobrist.cpp \
+        ..\openingbook.cpp \
+        ..\tablebase.cpp \
+        ..\transpositiontable.cpp \
+        ..\engine.cpp \
+        ..\targets.cpp \
+        ..\searchstats.cpp \
+        ..\trace.cpp \
+        ..\evaluation.cpp \
+        ..\movegenerator.cpp \
+        ..\network.cpp \
+        ..\playouts.cpp \
+        ..\latency.cpp \
+        ..\metrics.cpp
 
 HEADERS += \
     ..\battlefield.hpp \
     ..\unit.hpp \
     ..\action.hpp \
     ..\coordinates.hpp \
-    ..\tree.hpp
+    ..\tree.hpp \
+    ..\zobrist.hpp \
+    ..\openingbook.hpp \
+    ..\tablebase.hpp \
+    ..\transpositiontable.hpp \
+    ..\searchcache.hpp \
+    ..\engine.hpp \
+    ..\targets.hpp \
+    ..\geometry.hpp \
+    ..\searchstats.hpp \
+    ..\trace.hpp \
+    ..\evaluation.hpp \
+    ..\searchoptions.hpp \
+    ..\movegenerator.hpp \
+    ..\network.hpp \
+    ..\playouts.hpp \
+    ..\latency.hpp \
+    ..\metrics.hpp \
+    ..\symmetry.hpp
 
 
 DEFINES += SRCDIR=\\\"$$PWD/\\\"
@@ -4,13 +4,25 @@
 #include <QJsonDocument>
 #include <QFile>
 #include <QJsonArray>
+#include <QTemporaryDir>
 
 #include "tree.hpp"
 #include "battlefield.hpp"
 #include "unit.hpp"
+#include "network.hpp"
+#include "playouts.hpp"
+#include "latency.hpp"
+#include "metrics.hpp"
+#include "symmetry.hpp"
 
 
 #include <chrono>//perf test
+#include <random>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 int  main(void)
 {
@@ -51,6 +63,304 @@ int  main(void)
     qDebug() << "Tree generation = " << duration << " microseconds";
     qDebug() << "Number of units on the board : " << numberOfUnits;
 
+    // next turn : both players played the best turn,
+    // searched again with the cache of the first search, then without cache
+    BattleField next = btf;
+    for(int i = 0; i < 2; ++i){
+        Tree reply;
+        reply.generate(2, next);
+        reply.getBestAction().applyActions(next);
+        next.setId(1 - next.getId());
+    }
+
+    SearchCache cache;
+    Tree(cache).generate(treeDepth, btf);
+
+    t1 = std::chrono::high_resolution_clock::now();
+    Tree(cache).generate(treeDepth, next);
+    t2 = std::chrono::high_resolution_clock::now();
+    qDebug() << "Next turn with the search cache = " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " microseconds";
+
+    t1 = std::chrono::high_resolution_clock::now();
+    Tree().generate(treeDepth, next);
+    t2 = std::chrono::high_resolution_clock::now();
+    qDebug() << "Next turn without cache = " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " microseconds";
+
+    // what the first search did
+    SearchStats stats;
+    Tree instrumented;
+    instrumented.setStats(&stats);
+    instrumented.generate(treeDepth, btf);
+    qDebug() << "Search stats : " << QJsonDocument(stats.toJson()).toJson(QJsonDocument::Compact);
+
+    // turn generation alone
+    std::size_t generated = 0;
+    t1 = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < 10000; ++i)generated += btf.possibleTurns().size();
+    t2 = std::chrono::high_resolution_clock::now();
+    qDebug() << "10000 turn generations = " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " microseconds (" << generated << " turns)";
+
+    // evaluation network (random weights) : the accumulator updated on each
+    // turn must be the one computed from scratch, and the speed of the evaluation
+    Network::Weights networkWeights;
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> small(-0.5f, 0.5f);
+    for(std::vector<float> *layer : {&networkWeights.feature, &networkWeights.featureBias, &networkWeights.dense,
+        &networkWeights.denseBias, &networkWeights.output}){
+        for(float &w : *layer)w = small(random);
+    }
+    Network network;
+    network.setWeights(networkWeights);
+
+    BattleField followed = btf;
+    followed.setNetwork(&network);
+    int mismatches = 0;
+    for(int i = 0; i < 40; ++i){
+        std::vector<Turn> turns = followed.possibleTurns();
+        if(turns.empty() || followed.numberOfMyUnits() == 0)break;
+        turns[random() % turns.size()].applyActions(followed);
+        followed.setId(1 - followed.getId());
+
+        Network::Accumulator fresh;
+        network.refresh(followed, fresh);
+        if(fresh.values != followed.getAccumulator().values)++mismatches;
+    }
+    qDebug() << "Network accumulator mismatches after 40 turns :" << mismatches;
+    if(mismatches){
+        qDebug() << "The accumulator updated on each turn is wrong";
+        return 1;
+    }
+
+    float evalSum = 0.f;
+    t1 = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < 1000000; ++i)evalSum += network.evaluate(followed.getAccumulator(), static_cast<Unit::COLOR>(i & 1));
+    t2 = std::chrono::high_resolution_clock::now();
+    qDebug() << "1000000 network evaluations (" << Network::instructions() << ") = "
+             << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " microseconds (" << evalSum << ")";
+
+    Evaluation material;
+    evalSum = 0.f;
+    t1 = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < 1000000; ++i)evalSum += material.evaluate(btf);
+    t2 = std::chrono::high_resolution_clock::now();
+    qDebug() << "1000000 weights evaluations = " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " microseconds (" << evalSum << ")";
+
+    // search evaluated by the network, loaded from a file (removed with its directory)
+    Evaluation networkEvaluation;
+    QTemporaryDir networkDir;
+    const QString networkPath = networkDir.filePath("test.nnue");
+    if(networkDir.isValid() && network.save(networkPath) && networkEvaluation.loadNetwork(networkPath)){
+        SearchStats networkStats;
+        Tree networkTree;
+        networkTree.setEvaluation(&networkEvaluation);
+        networkTree.setStats(&networkStats);
+        networkTree.generate(treeDepth, btf);
+        qDebug() << "Search with the network :" << networkStats.nodes << "nodes," << networkStats.leaves << "leaves in" << networkStats.time() << "microseconds";
+    }
+
+    // latency histogram : 1 to 100000 microseconds, p50 and p99 within the 3% of a bucket
+    LatencyHistogram latency;
+    for(qint64 micros = 1; micros <= 100000; ++micros)latency.record(micros);
+    qDebug() << "Latency histogram of 1 to 100000 microseconds : p50" << latency.percentile(50.)
+             << "p99" << latency.percentile(99.) << "max" << latency.getMax();
+
+    // symmetric battlefields : same canonical hash, and the same turns once turned back
+    int symmetryMismatches = 0;
+    for(int symmetry = 0; symmetry < Symmetry::COUNT; ++symmetry){
+        QJsonArray units;
+        for(const std::shared_ptr<Unit> &unit : followed.getUnits()){
+            QJsonObject pawn, coordinates, obj;
+            pawn["color"] = Symmetry::color(symmetry, unit->getColor());
+            pawn["type"] = unit->getType();
+            Coordinates square = Coordinates::fromIndex(Symmetry::field(symmetry, unit->getPosition().index()));
+            coordinates["x"] = square.x;
+            coordinates["y"] = square.y;
+            obj["coordinates"] = coordinates;
+            obj["pawn"] = pawn;
+            units.append(obj);
+        }
+        BattleField symmetric;
+        symmetric.setId(Symmetry::color(symmetry, static_cast<Unit::COLOR>(followed.getId())));
+        symmetric.fillField(units);
+
+        int original, turned;
+        if(symmetric.canonicalHash(turned) != followed.canonicalHash(original))++symmetryMismatches;
+        //without the mirrored fields (evaluation network), only the flipped field shares the hash
+        const bool shared = symmetric.canonicalHash(turned, false) == followed.canonicalHash(original, false);
+        if(shared != !(symmetry & Symmetry::MIRROR))++symmetryMismatches;
+        std::vector<quint32> expected, found;
+        for(const Turn &turn : followed.possibleTurns())expected.push_back(Symmetry::turn(symmetry, turn.pack()));
+        for(const Turn &turn : symmetric.possibleTurns())found.push_back(turn.pack());
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        if(expected != found)++symmetryMismatches;
+    }
+    qDebug() << "Symmetric battlefields with another hash or other turns :" << symmetryMismatches;
+    if(symmetryMismatches){
+        qDebug() << "The symmetric battlefields don't match";
+        return 1;
+    }
+
+    // fractional scores : the bounds saved in the table stay bounds of the score
+    {
+        TranspositionTable bounds(1);
+        TranspositionTable::Data lower = {}, upper = {};
+        bounds.store(btf.hash(), 0, 10.6f, 1, TranspositionTable::LOWER);
+        bounds.probe(btf.hash(), lower);
+        bounds.store(btf.hash() ^ 1, 0, 10.4f, 1, TranspositionTable::UPPER);
+        bounds.probe(btf.hash() ^ 1, upper);
+        qDebug() << "Bounds of 10.6 and 10.4 saved as" << lower.score << "and" << upper.score;
+        if(lower.score > 10.6f || upper.score < 10.4f)return 1;
+    }
+
+#ifdef Q_OS_UNIX
+    // shared transposition table : a second table mapping the same memory finds what the first one stored
+    {
+        const QString sharedName = QString("/guerrilla-test-%1").arg(qint64(getpid()));
+        TranspositionTable writer, reader, other;
+        TranspositionTable::Data shared = {};
+        const Evaluation evaluation;
+        Evaluation::Features otherWeights = evaluation.getWeights();
+        otherWeights[Evaluation::MATERIAL] += 1.f;
+        Evaluation otherEvaluation;
+        otherEvaluation.setWeights(otherWeights);
+        bool found = false, mixed = true;
+        if(writer.share(sharedName, 1, evaluation.checksum()) && reader.share(sharedName, 1, evaluation.checksum())){
+            writer.store(btf.hash(), 1234, 42.f, 3, TranspositionTable::EXACT);
+            found = reader.probe(btf.hash(), shared) && !reader.probe(btf.hash() ^ (1ULL << 63), shared);
+            mixed = other.share(sharedName, 1, otherEvaluation.checksum());
+        }
+        shm_unlink(sharedName.toLocal8Bit().constData());
+        qDebug() << "Shared transposition table :" << (found ? "entry found by the other table" : "not shared")
+                 << (mixed ? ", shared with another evaluation" : ", not shared with another evaluation");
+        if(!found || mixed)return 1;
+    }
+#endif
+
+    // metrics exposition of a session that played the latencies above
+    MetricsRegistry registry;
+    SessionMetrics sessionMetrics;
+    sessionMetrics.playing = true;
+    sessionMetrics.turns = 1;
+    sessionMetrics.nodes = stats.nodes;
+    sessionMetrics.tableUsage = cache.table.usage();
+    sessionMetrics.latencies.total = latency;
+    registry.update("test", sessionMetrics);
+    registry.setSearching("test", true);
+    QByteArray exposition = registry.exposition();
+    qDebug() << "Metrics exposition :" << exposition.size() << "bytes,"
+             << std::count(exposition.begin(), exposition.end(), '\n') << "lines, table usage" << sessionMetrics.tableUsage;
+
+    // fixed depth and fixed time searches on each board
+    const char *boards[] = {":/config.json", ":/config_backup.json"};
+    for(const char *board : boards){
+        QFile boardFile(board);
+        if(!boardFile.open(QIODevice::ReadOnly | QIODevice::Text))continue;
+        BattleField field;
+        field.setId(0);
+        field.fillField(QJsonDocument::fromJson(boardFile.readAll()).object().value("data").toArray());
+
+        // random playouts : copies of the battlefield, one game after the other,
+        // against the batched playouts (all the games on the same arrays)
+        const int playoutTurns = 100;
+        int copyWins = 0, copyGames = 64;
+        t1 = std::chrono::high_resolution_clock::now();
+        for(int game = 0; game < copyGames; ++game){
+            BattleField played = field;
+            for(int turn = 0; turn < playoutTurns; ++turn){
+                if(played.numberOfMyUnits() == 0){
+                    copyWins += played.getId() != field.getId();
+                    break;
+                }
+                std::vector<Turn> turns = played.possibleTurns();
+                if(!turns.empty())turns[std::rand() % turns.size()].applyActions(played);
+                played.setId(1 - played.getId());
+            }
+        }
+        t2 = std::chrono::high_resolution_clock::now();
+        qDebug() << board << copyGames << "playouts of battlefield copies =" << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()
+                 << "microseconds (" << copyWins << "wins )";
+
+        Playouts playouts(256);
+        t1 = std::chrono::high_resolution_clock::now();
+        float chances = 0.f;
+        for(int batch = 0; batch < 4; ++batch)chances += playouts.run(field, playoutTurns) / 4;
+        t2 = std::chrono::high_resolution_clock::now();
+        qDebug() << board << 4 * 256 << "batched playouts =" << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()
+                 << "microseconds (" << playouts.getWins() << "wins," << playouts.getDraws() << "draws in the last batch, chances" << chances << ")";
+
+        // nodes to a fixed depth, with and without the symmetric positions sharing their entries
+        for(int symmetries = 0; symmetries < 2; ++symmetries){
+            SearchOptions options;
+            options.symmetries = symmetries == 1;
+            SearchStats symmetryStats;
+            Tree symmetric;
+            symmetric.setOptions(options);
+            symmetric.setStats(&symmetryStats);
+            symmetric.generate(4, field);
+            qDebug() << board << (symmetries ? "canonical hashes :" : "plain hashes :") << symmetryStats.nodes << "nodes to depth 4,"
+                     << symmetryStats.tableHits << "table hits";
+        }
+
+        // probes of a large transposition table, in normal pages and in huge pages
+        for(int huge = 0; huge < 2; ++huge){
+            SearchCache largeCache;
+            largeCache.table.resize(256, huge == 1);
+            SearchStats probeStats;
+            Tree large(largeCache);
+            large.setStats(&probeStats);
+            large.generate(4, field);
+            qDebug() << board << (huge ? "huge pages" : "normal pages") << "(" << largeCache.table.hasHugePages() << ") :"
+                     << probeStats.nodes << "nodes to depth 4, hit rate" << probeStats.tableHitRate()
+                     << ", probe latency" << probeStats.probeLatency() << "ns";
+        }
+
+        // nodes to a fixed depth, with and without the principal variation search and aspiration windows
+        for(int windows = 0; windows < 2; ++windows){
+            SearchOptions options;
+            options.principalVariation = options.aspiration = windows == 1;
+            SearchStats fixedStats;
+            Tree fixed;
+            fixed.setOptions(options);
+            fixed.setStats(&fixedStats);
+            fixed.generate(3, field);
+            qDebug() << board << (windows ? "principal variation search :" : "alpha-beta :") << fixedStats.nodes << "nodes to depth 3,"
+                     << "principal variation of" << fixed.getPrincipalVariation().size() << "turns";
+        }
+
+        for(int selective = 0; selective < 5; ++selective){
+            SearchOptions options;
+            options.nullMove = selective == 1 || selective == 4;
+            options.lateMoveReductions = selective == 2 || selective == 4;
+            options.futility = selective == 3 || selective == 4;
+            options.timeLimit = 500;
+
+            const char *names[] = {"none", "null move", "late move reductions", "futility", "all"};
+            SearchStats timedStats;
+            Tree timed;
+            timed.setOptions(options);
+            timed.setStats(&timedStats);
+            timed.generate(64, field);
+            qDebug() << board << "500ms, selective search" << names[selective] << ": depth" << timed.getDepth()
+                     << "(" << timedStats.nodes << "nodes )";
+        }
+
+        // node and memory budgets : the search stops deepening and says why
+        for(int budget = 0; budget < 2; ++budget){
+            SearchOptions options;
+            options.nodeLimit = budget ? 0 : 20000;
+            options.memoryLimit = budget ? 64 * 1024 : 0;
+            SearchStats budgetStats;
+            Tree bounded;
+            bounded.setOptions(options);
+            bounded.setStats(&budgetStats);
+            bounded.generate(64, field);
+            qDebug() << board << (budget ? "64kB budget :" : "20000 nodes budget :") << "depth" << bounded.getDepth()
+                     << "(" << budgetStats.nodes << "nodes," << budgetStats.peakMemory << "bytes ), stopped by"
+                     << SearchOptions::stopName(bounded.getStopReason());
+        }
+    }
+
     return 0;
 
 }
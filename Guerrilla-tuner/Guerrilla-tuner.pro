@@ -0,0 +1,69 @@
+#-------------------------------------------------
+#
+# Evaluation tuner : fits the weights of the evaluation
+# to the results of recorded games (texel tuning),
+# on all the cores
+#
+#-------------------------------------------------
+
+QT       += websockets
+
+QT       -= gui
+
+INCLUDEPATH += ".."
+
+TARGET = Guerrilla-tuner
+CONFIG   += console c++14 thread
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+include(../geometry.pri)
+include(../trace.pri)
+include(../simd.pri)
+include(../sharedmemory.pri)
+
+SOURCES += \
+        main.cpp  \
+        ..\battlefield.cpp \
+        ..\unit.cpp \
+        ..\action.cpp \
+        ..\tree.cpp \
+        ..\zobrist.cpp \
+        ..\openingbook.cpp \
+        ..\tablebase.cpp \
+        ..\transpositiontable.cpp \
+        ..\targets.cpp \
+        ..\engine.cpp \
+        ..\gamerecord.cpp \
+        ..\searchstats.cpp \
+        ..\trace.cpp \
+        ..\evaluation.cpp \
+        ..\movegenerator.cpp \
+        ..\network.cpp \
+        ..\boardsync.cpp
+
+HEADERS += \
+    ..\battlefield.hpp \
+    ..\unit.hpp \
+    ..\action.hpp \
+    ..\coordinates.hpp \
+    ..\tree.hpp \
+    ..\zobrist.hpp \
+    ..\openingbook.hpp \
+    ..\tablebase.hpp \
+    ..\transpositiontable.hpp \
+    ..\searchcache.hpp \
+    ..\targets.hpp \
+    ..\geometry.hpp \
+    ..\engine.hpp \
+    ..\gamerecord.hpp \
+    ..\searchstats.hpp \
+    ..\trace.hpp \
+    ..\evaluation.hpp \
+    ..\searchoptions.hpp \
+    ..\movegenerator.hpp \
+    ..\network.hpp \
+    ..\symmetry.hpp \
+    ..\boardsync.hpp
@@ -0,0 +1,578 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   main.cpp
+ * Author: azarias
+ *
+ * Created on 6/3/2018
+ */
+#include <QString>
+#include <QJsonArray>
+#include <QDebug>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "battlefield.hpp"
+#include "evaluation.hpp"
+#include "gamerecord.hpp"
+#include "network.hpp"
+
+namespace {
+
+/**
+ * @brief The Sample struct a position where a client played,
+ * and the result of the game for that client
+ */
+struct Sample{
+    Evaluation::Features features;
+
+    /**
+     * @brief inputs the features of the network, on the side
+     * of the player, then on the side of the opponent
+     */
+    std::array<std::vector<quint16>, 2> inputs;
+
+    /**
+     * @brief result 1 if won, 0 if lost, 0.5 for a draw
+     */
+    float result;
+};
+
+/**
+ * @brief readRecord keeps the positions where the client played
+ * (see GameRecordReader::getField).
+ * The positions of a game without result (draw in the arena,
+ * or unfinished game) are draws
+ * @param path
+ * @param samples
+ * @param skipped incremented for each decision whose position does not match the record
+ * @return wether the record could be read
+ */
+bool readRecord(const QString &path, std::vector<Sample> &samples, int &skipped)
+{
+    GameRecordReader reader;
+    if(!reader.open(path)){
+        qDebug() << "Invalid game record" << path;
+        return false;
+    }
+
+    std::vector<Sample> game;
+
+    auto finishGame = [&](float result){
+        for(Sample &sample : game)sample.result = result;
+        samples.insert(samples.end(), game.begin(), game.end());
+        game.clear();
+    };
+
+    GameRecord::Entry entry;
+    while(reader.next(entry)){
+        if(entry.kind == GameRecord::DECISION){
+            const BattleField &field = reader.getField();
+            if(entry.hash != field.hash()){
+                ++skipped;//the position does not match the record
+                continue;
+            }
+
+            Sample sample;
+            Evaluation::features(field, sample.features);
+            const Unit::COLOR player = static_cast<Unit::COLOR>(field.getId());
+            for(const std::shared_ptr<Unit> &unit : field.getUnits()){
+                for(int side = 0; side < 2; ++side){
+                    const Unit::COLOR color = side ? static_cast<Unit::COLOR>(1 - player) : player;
+                    sample.inputs[side].push_back(Network::feature(color, unit->getColor(), unit->getType(), unit->getPosition().index()));
+                }
+            }
+            game.push_back(sample);
+        }else if(entry.kind == GameRecord::WIN || entry.kind == GameRecord::LOOSE){
+            finishGame(entry.kind == GameRecord::WIN ? 1.f : 0.f);
+        }
+    }
+    finishGame(0.5f);
+    return true;
+}
+
+/**
+ * @brief meanError mean squared error between the results and the
+ * win probability predicted by the evaluation : 1 / (1 + exp(-k * eval)),
+ * computed on all the threads
+ * @param samples
+ * @param weights
+ * @param k
+ * @param threads
+ * @return
+ */
+double meanError(const std::vector<Sample> &samples, const Evaluation::Features &weights, double k, int threads)
+{
+    std::vector<double> sums(threads, 0.);
+    std::size_t chunk = (samples.size() + threads - 1) / threads;
+
+    std::vector<std::thread> pool;
+    for(int t = 0; t < threads; ++t){
+        pool.emplace_back([&, t](){
+            std::size_t end = std::min(samples.size(), (t + 1) * chunk);
+            double sum = 0.;
+            for(std::size_t i = t * chunk; i < end; ++i){
+                double eval = 0.;
+                for(int f = 0; f < Evaluation::FEATURES; ++f)eval += weights[f] * samples[i].features[f];
+                double error = samples[i].result - 1. / (1. + std::exp(-k * eval));
+                sum += error * error;
+            }
+            sums[t] = sum;
+        });
+    }
+    for(std::thread &thread : pool)thread.join();
+
+    double total = 0.;
+    for(double sum : sums)total += sum;
+    return total / samples.size();
+}
+
+/**
+ * @brief fitScale the scale k of the sigmoid that fits the
+ * best the given weights (golden section search, on log10 k)
+ * @param samples
+ * @param weights
+ * @param threads
+ * @return
+ */
+double fitScale(const std::vector<Sample> &samples, const Evaluation::Features &weights, int threads)
+{
+    const double ratio = (std::sqrt(5.) - 1.) / 2.;
+    double low = -6., high = 1.;
+    for(int i = 0; i < 40; ++i){
+        double a = high - ratio * (high - low);
+        double b = low + ratio * (high - low);
+        if(meanError(samples, weights, std::pow(10., a), threads) < meanError(samples, weights, std::pow(10., b), threads)){
+            high = b;
+        }else{
+            low = a;
+        }
+    }
+    return std::pow(10., (low + high) / 2.);
+}
+
+/**
+ * @brief The Trainer class trains the weights of the evaluation network
+ * (as floats, with the same clipped activations as the network) to the results
+ * of the samples, with the sigmoid of the weights : stochastic gradient
+ * descent with Adam, the rows of the first layer are only updated
+ * when one of their features was in the batch.
+ * Each feature is seen in few positions : the first layer also has a row
+ * per unit color and type (whatever its field), shared by all the features
+ * of the unit, and added to their rows when the weights are written
+ */
+class Trainer
+{
+public:
+    static const int BATCH = 256;
+
+    Trainer(double k, double rate):
+        mK(k),
+        mRate(rate),
+        mFactor(UNITS * Network::HIDDEN, 0.f),
+        mParameters{&mWeights.feature, &mFactor, &mWeights.featureBias, &mWeights.dense, &mWeights.denseBias, &mWeights.output, &mOutputBias}
+    {
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> small(-0.2f, 0.2f);
+        for(float &w : mWeights.feature)w = small(random);
+        for(float &w : mWeights.featureBias)w = 0.5f;
+        for(float &w : mWeights.dense)w = small(random);
+        for(float &w : mWeights.denseBias)w = 0.5f;
+        for(float &w : mWeights.output)w = small(random);
+
+        for(int p = 0; p < PARAMETERS; ++p){
+            mGradients[p].assign(mParameters[p]->size(), 0.f);
+            mMoments[p].assign(mParameters[p]->size(), 0.f);
+            mSquares[p].assign(mParameters[p]->size(), 0.f);
+        }
+        mTouched.assign(Network::INPUTS, false);
+    }
+
+    /**
+     * @brief UNITS unit colors and types : features of a unit, whatever its field
+     */
+    static const int UNITS = Network::INPUTS / Geometry::SIZE;
+
+    /**
+     * @brief DECAY the rows of the fields are pulled to 0 : they only keep
+     * what the rows of the units can't learn (else they learn the games by heart)
+     */
+    static constexpr float DECAY = 0.01f;
+
+    /**
+     * @brief epoch goes once through the samples (shuffled)
+     * @param samples
+     * @param random
+     * @return the mean error of the samples
+     */
+    double epoch(const std::vector<Sample> &samples, std::mt19937 &random)
+    {
+        std::vector<std::size_t> order(samples.size());
+        for(std::size_t i = 0; i < order.size(); ++i)order[i] = i;
+        std::shuffle(order.begin(), order.end(), random);
+
+        double error = 0.;
+        for(std::size_t start = 0; start < order.size(); start += BATCH){
+            std::size_t end = std::min(order.size(), start + BATCH);
+            for(std::size_t i = start; i < end; ++i)error += backward(samples[order[i]]);
+            step(end - start);
+        }
+        return error / samples.size();
+    }
+
+    /**
+     * @brief getWeights
+     * @return the trained weights
+     */
+    Network::Weights getWeights() const
+    {
+        Network::Weights weights = mWeights;
+        for(int f = 0; f < Network::INPUTS; ++f){
+            for(int h = 0; h < Network::HIDDEN; ++h)weights.feature[f * Network::HIDDEN + h] += mFactor[(f / Geometry::SIZE) * Network::HIDDEN + h];
+        }
+        weights.outputBias = mOutputBias[0];
+        return weights;
+    }
+
+private:
+    enum PARAMETER {FEATURE, FACTOR, FEATURE_BIAS, DENSE, DENSE_BIAS, OUTPUT, OUTPUT_BIAS, PARAMETERS};
+
+    static float clip(float value)
+    {
+        return std::min(std::max(value, 0.f), 1.f);
+    }
+
+    /**
+     * @brief backward adds the gradients of the error of a sample
+     * @param sample
+     * @return the error of the sample
+     */
+    double backward(const Sample &sample)
+    {
+        const int H = Network::HIDDEN, D = Network::DENSE;
+        float accumulator[2 * H], input[2 * H], dense[D], hidden[D];
+        for(int side = 0; side < 2; ++side){
+            for(int h = 0; h < H; ++h)accumulator[side * H + h] = mWeights.featureBias[h];
+            for(quint16 f : sample.inputs[side]){
+                const int unit = f / Geometry::SIZE;
+                for(int h = 0; h < H; ++h)accumulator[side * H + h] += mWeights.feature[f * H + h] + mFactor[unit * H + h];
+            }
+        }
+        for(int i = 0; i < 2 * H; ++i)input[i] = clip(accumulator[i]);
+
+        float output = mOutputBias[0];
+        for(int j = 0; j < D; ++j){
+            dense[j] = mWeights.denseBias[j];
+            for(int i = 0; i < 2 * H; ++i)dense[j] += mWeights.dense[j * 2 * H + i] * input[i];
+            hidden[j] = clip(dense[j]);
+            output += mWeights.output[j] * hidden[j];
+        }
+
+        const double prediction = 1. / (1. + std::exp(-mK * output * Network::OUTPUT_SCALE));
+        const double error = prediction - sample.result;
+        const float gradient = 2. * error * prediction * (1. - prediction) * mK * Network::OUTPUT_SCALE;
+
+        float inputGradient[2 * H] = {};
+        mGradients[OUTPUT_BIAS][0] += gradient;
+        for(int j = 0; j < D; ++j){
+            mGradients[OUTPUT][j] += gradient * hidden[j];
+            if(dense[j] <= 0.f || dense[j] >= 1.f)continue;
+            const float denseGradient = gradient * mWeights.output[j];
+            mGradients[DENSE_BIAS][j] += denseGradient;
+            for(int i = 0; i < 2 * H; ++i){
+                mGradients[DENSE][j * 2 * H + i] += denseGradient * input[i];
+                inputGradient[i] += denseGradient * mWeights.dense[j * 2 * H + i];
+            }
+        }
+
+        for(int side = 0; side < 2; ++side){
+            for(int h = 0; h < H; ++h){
+                const float a = accumulator[side * H + h];
+                if(a <= 0.f || a >= 1.f)inputGradient[side * H + h] = 0.f;
+                mGradients[FEATURE_BIAS][h] += inputGradient[side * H + h];
+            }
+            for(quint16 f : sample.inputs[side]){
+                if(!mTouched[f]){
+                    mTouched[f] = true;
+                    mTouchedRows.push_back(f);
+                }
+                for(int h = 0; h < H; ++h){
+                    mGradients[FEATURE][f * H + h] += inputGradient[side * H + h];
+                    mGradients[FACTOR][(f / Geometry::SIZE) * H + h] += inputGradient[side * H + h];
+                }
+            }
+        }
+        return error * error;
+    }
+
+    /**
+     * @brief step updates the weights with the gradients of a batch
+     * @param size number of samples of the batch
+     */
+    void step(std::size_t size)
+    {
+        ++mSteps;
+        for(int p = 0; p < PARAMETERS; ++p){
+            if(p == FEATURE){
+                for(quint16 row : mTouchedRows){
+                    for(int h = 0; h < Network::HIDDEN; ++h)update(p, row * Network::HIDDEN + h, size);
+                    mTouched[row] = false;
+                }
+                mTouchedRows.clear();
+            }else{
+                for(std::size_t i = 0; i < mParameters[p]->size(); ++i)update(p, i, size);
+            }
+        }
+    }
+
+    void update(int p, std::size_t i, std::size_t size)
+    {
+        const float beta1 = 0.9f, beta2 = 0.999f;
+        float gradient = mGradients[p][i] / size;
+        if(p == FEATURE)gradient += DECAY * (*mParameters[p])[i];
+        mGradients[p][i] = 0.f;
+        mMoments[p][i] = beta1 * mMoments[p][i] + (1.f - beta1) * gradient;
+        mSquares[p][i] = beta2 * mSquares[p][i] + (1.f - beta2) * gradient * gradient;
+        const double moment = mMoments[p][i] / (1. - std::pow(beta1, mSteps));
+        const double square = mSquares[p][i] / (1. - std::pow(beta2, mSteps));
+        float &weight = (*mParameters[p])[i];
+        weight -= mRate * moment / (std::sqrt(square) + 1e-8);
+        //the accumulator is on 16 bits : a feature can't weigh too much
+        if(p == FEATURE || p == FACTOR)weight = std::min(std::max(weight, -1.f), 1.f);
+    }
+
+    double mK;
+
+    double mRate;
+
+    Network::Weights mWeights;
+
+    /**
+     * @brief mFactor the rows of the units, whatever their field
+     */
+    std::vector<float> mFactor;
+
+    std::vector<float> mOutputBias = {0.f};
+
+    std::vector<float> *mParameters[PARAMETERS];
+
+    std::vector<float> mGradients[PARAMETERS];
+
+    std::vector<float> mMoments[PARAMETERS];
+
+    std::vector<float> mSquares[PARAMETERS];
+
+    /**
+     * @brief mTouched the rows of the first layer with a gradient in the batch
+     */
+    std::vector<bool> mTouched;
+
+    std::vector<quint16> mTouchedRows;
+
+    int mSteps = 0;
+};
+
+/**
+ * @brief networkError mean squared error of the quantized network
+ * @param samples
+ * @param network
+ * @param k
+ * @return
+ */
+double networkError(const std::vector<Sample> &samples, const Network &network, double k)
+{
+    double sum = 0.;
+    Network::Accumulator accumulator;
+    for(const Sample &sample : samples){
+        network.reset(accumulator);
+        for(int side = 0; side < 2; ++side){
+            //the player plays white : its side is the first one
+            for(quint16 f : sample.inputs[side])network.addFeature(accumulator, side ? Unit::BLACK : Unit::WHITE, f);
+        }
+        double error = sample.result - 1. / (1. + std::exp(-k * network.evaluate(accumulator, Unit::WHITE)));
+        sum += error * error;
+    }
+    return sum / samples.size();
+}
+
+}
+
+/**
+ * @brief main fits the weights of the evaluation to the results
+ * of recorded games (texel tuning) :
+ * the scale of the sigmoid is fitted to the starting weights, then
+ * each weight is moved as long as it lowers the error, with a
+ * smaller and smaller step
+ * usage : Guerrilla-tuner [options] <record>...
+ *   --threads <n>       threads computing the error (all the cores)
+ *   --weights <file>    starting weights (the default ones)
+ *   --output <file>     weights file written (weights.json)
+ *   --network <file>    trains the evaluation network instead, and writes it
+ *                       to the given file (the scale of the sigmoid is the one
+ *                       of the weights, so that both give the same kind of scores)
+ *   --epochs <n>        passes of the network training over the positions (30)
+ * the records are the ones of the client, or of Guerrilla-arena --records
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main(int argc, char *argv[])
+{
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    QString output = "weights.json";
+    QString networkPath;
+    int epochs = 30;
+    QStringList records;
+    Evaluation evaluation;
+    std::vector<Sample> samples;
+
+    for(int i = 1; i < argc; ++i){
+        QString arg = argv[i];
+        if(arg.startsWith("--")){
+            if(i + 1 >= argc){
+                qDebug() << "Missing value for" << arg;
+                return 1;
+            }
+            QString value = argv[++i];
+            if(arg == "--threads")threads = std::max(1, value.toInt());
+            else if(arg == "--output")output = value;
+            else if(arg == "--network")networkPath = value;
+            else if(arg == "--epochs")epochs = std::max(1, value.toInt());
+            else if(arg == "--weights"){
+                if(!evaluation.load(value)){
+                    qDebug() << "Failed to load the weights" << value;
+                    return 1;
+                }
+            }else{
+                qDebug() << "Unknown option" << arg;
+                return 1;
+            }
+            continue;
+        }
+
+        records << arg;
+    }
+
+    //the network learns the positions by heart : one game in ten is kept
+    //apart to check it, and the weights of its best epoch are kept
+    std::vector<Sample> validation;
+    int recordIndex = 0, skipped = 0;
+    for(const QString &record : records){
+        const bool validating = !networkPath.isEmpty() && ++recordIndex % 10 == 0;
+        if(!readRecord(record, validating ? validation : samples, skipped))return 1;
+    }
+    if(skipped)qDebug() << skipped << "positions skipped : they do not match their record";
+
+    if(samples.empty()){
+        qDebug() << "Usage :" << argv[0] << "[--threads n] [--weights file] [--output file] [--network file] [--epochs n] <record>...";
+        qDebug() << "(no position found in the records)";
+        return 1;
+    }
+
+    int results[3] = {0, 0, 0};
+    for(const Sample &sample : samples)++results[int(sample.result * 2.f)];
+    qDebug().noquote() << QString("%1 positions : %2 won, %3 drawn, %4 lost")
+                          .arg(qint64(samples.size())).arg(results[2]).arg(results[1]).arg(results[0]);
+    if(results[0] + results[2] == 0){
+        qDebug() << "No game won or lost, nothing to fit";
+        return 1;
+    }
+
+    Evaluation::Features weights = evaluation.getWeights();
+    const double k = fitScale(samples, weights, threads);
+    double error = meanError(samples, weights, k, threads);
+    qDebug().noquote() << QString("k = %1, error = %2").arg(k).arg(error);
+
+    if(!networkPath.isEmpty()){
+        if(validation.empty()){
+            qDebug() << "At least ten records are needed to train the network";
+            return 1;
+        }
+        const double weightsError = meanError(validation, weights, k, threads);
+
+        Trainer trainer(k, 0.001);
+        std::mt19937 random(1);
+        Network network;
+        double bestError = 1.;
+        for(int epoch = 1; epoch <= epochs; ++epoch){
+            double trainingError = trainer.epoch(samples, random);
+            Network trained;
+            trained.setWeights(trainer.getWeights());
+            double validationError = networkError(validation, trained, k);
+            qDebug().noquote() << QString("epoch %1 : error = %2, kept games : %3").arg(epoch).arg(trainingError).arg(validationError);
+            if(validationError < bestError){
+                bestError = validationError;
+                network = trained;
+            }
+        }
+
+        qDebug().noquote() << QString("kept games (%1 positions) : network error = %2, weights error = %3")
+                              .arg(qint64(validation.size())).arg(bestError).arg(weightsError);
+        if(!network.save(networkPath)){
+            qDebug() << "Failed to write the network" << networkPath;
+            return 1;
+        }
+        qDebug() << "Network written to" << networkPath;
+        return 0;
+    }
+
+    for(double step = 8.; step >= 0.25; step /= 2.){
+        bool improved = true;
+        while(improved){
+            improved = false;
+            for(int f = 0; f < Evaluation::FEATURES; ++f){
+                for(double direction : {1., -1.}){
+                    Evaluation::Features tried = weights;
+                    tried[f] += direction * step;
+                    double triedError = meanError(samples, tried, k, threads);
+                    if(triedError < error){
+                        weights = tried;
+                        error = triedError;
+                        improved = true;
+                        break;
+                    }
+                }
+            }
+        }
+        qDebug().noquote() << QString("step %1 : error = %2").arg(step).arg(error);
+    }
+
+    evaluation.setWeights(weights);
+    for(int f = 0; f < Evaluation::FEATURES; ++f){
+        qDebug().noquote() << Evaluation::featureName(f) << weights[f];
+    }
+
+    if(!evaluation.save(output)){
+        qDebug() << "Failed to write the weights" << output;
+        return 1;
+    }
+    qDebug() << "Weights written to" << output;
+    return 0;
+}
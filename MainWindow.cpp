@@ -30,35 +30,117 @@
  */
 #include <QDebug>
 #include <QJsonDocument>
-#include <QJsonArray>
 #include "MainWindow.hpp"
-#include <QPushButton>
+#include "trace.hpp"
 #include <QMessageBox>
-#include <QProgressDialog>
-#include "math.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
 
-#include "tree.hpp"
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
     mWebSocket(),
-    mLayout(new QGridLayout())
+    mSession(*this),
+    mBoard(new BoardWidget(mSession.getBattleField())),
+    // CHANGE THE URL HERE TO CONNECT TO ANOTHER SERVER
+    mServerUrl("ws://localhost:5000")
 {
-    QWidget *center = new QWidget();
-    center->setLayout(mLayout);
+    setCentralWidget(mBoard);
+
+    connect(mBoard, &BoardWidget::squareClicked, [](const Coordinates &coords){
+        qDebug() << "(x:"<<coords.x<<", y "<<coords.y<<")\n";//print the coordinates of a square when clicked
+    });
 
-    setCentralWidget(center);
+    mReconnectTimer.setSingleShot(true);
 
     connect(&mWebSocket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(error(QAbstractSocket::SocketError)));
     connect(&mWebSocket, &QWebSocket::connected, this, &MainWindow::connected);
+    connect(&mWebSocket, &QWebSocket::disconnected, this, &MainWindow::disconnected);
+    connect(&mWebSocket, &QWebSocket::textMessageReceived, this, &MainWindow::messageReceived);
+    connect(&mReconnectTimer, &QTimer::timeout, this, &MainWindow::reconnect);
+    connect(&mLatencyTimer, &QTimer::timeout, this, &MainWindow::dumpLatencies);
 
-    // CHANGE THE URL HERE TO CONNECT TO ANOTHER SERVER
-    mWebSocket.open(QUrl("ws://localhost:5000"));
+    if(mSession.getEngine().loadOpeningBook("opening.book")){
+        qDebug() << "Opening book loaded";
+    }
+
+    if(int tables = mSession.getEngine().loadTablebases("tablebases")){
+        qDebug() << "Tablebases loaded :" << tables << "tables";
+    }
+
+    if(mSession.getEngine().loadWeights("weights.json")){
+        qDebug() << "Evaluation weights loaded";
+    }
+
+    if(mSession.getEngine().loadNetwork("network.nnue")){
+        qDebug() << "Evaluation network loaded (" << Network::instructions() << ")";
+    }
+
+    QDir().mkpath("records");
+    //the pid : the bots of a host may start in the same second
+    QString recordPath = QString("records/%1-%2.grec")
+            .arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"))
+            .arg(QCoreApplication::applicationPid());
+    if(!mSession.getRecorder().open(recordPath)){
+        qWarning() << "Could not open the game record" << recordPath;
+    }
+
+    if(qEnvironmentVariableIsSet("GUERRILLA_SEARCH_LOG")){
+        QString logPath = QString::fromLocal8Bit(qgetenv("GUERRILLA_SEARCH_LOG"));
+        mSession.getEngine().enableStats(logPath);
+        qDebug() << "Search stats logged to" << logPath;
+    }
+
+    //transposition table shared by all the clients of the host, in huge pages if asked
+    TranspositionTable &table = mSession.getEngine().getCache().table;
+    const bool hugePages = qEnvironmentVariableIntValue("GUERRILLA_HUGE_PAGES") > 0;
+    if(qEnvironmentVariableIsSet("GUERRILLA_SHARED_TABLE")){
+        QString tableName = QString::fromLocal8Bit(qgetenv("GUERRILLA_SHARED_TABLE"));
+        int megabytes = qEnvironmentVariableIntValue("GUERRILLA_SHARED_TABLE_MB");
+        quint64 evaluation = mSession.getEngine().getEvaluation().checksum();
+        if(table.share(tableName, megabytes > 0 ? megabytes : 64, evaluation, hugePages)){
+            qDebug() << "Transposition table shared as" << tableName;
+        }
+    }
+    if(hugePages && !table.isShared())table.resize(table.memoryUsage() / (1024 * 1024), true);
+    if(hugePages)qDebug() << "Transposition table in huge pages :" << table.hasHugePages();
+
+    //limits of the search, so that a bot sharing its host can't take all of it
+    SearchOptions options = mSession.getEngine().getOptions();
+    options.nodeLimit = qgetenv("GUERRILLA_MAX_NODES").toULongLong();
+    options.memoryLimit = qgetenv("GUERRILLA_MAX_MEMORY").toULongLong() * 1024;
+    mSession.getEngine().setOptions(options);
+
+    if(qEnvironmentVariableIsSet("GUERRILLA_TRACE_FILE")){
+        QString tracePath = QString::fromLocal8Bit(qgetenv("GUERRILLA_TRACE_FILE"));
+        if(Trace::start(tracePath))qDebug() << "Tracing to" << tracePath;
+        else qWarning() << "Tracing is not compiled in (qmake CONFIG+=tracing)";
+    }
+
+    //latencies of the turns, dumped every minute (or every GUERRILLA_LATENCY_PERIOD seconds)
+    mLatencyLog = QString::fromLocal8Bit(qgetenv("GUERRILLA_LATENCY_LOG"));
+    int latencyPeriod = qEnvironmentVariableIntValue("GUERRILLA_LATENCY_PERIOD");
+    mLatencyTimer.start((latencyPeriod > 0 ? latencyPeriod : 60) * 1000);
+
+    //metrics on the loopback, to be scraped by the host of the bots
+    int metricsPort = qEnvironmentVariableIntValue("GUERRILLA_METRICS_PORT");
+    if(metricsPort > 0){
+        mSession.setMetrics(&mMetrics, QFileInfo(recordPath).baseName());
+        mMetricsServer.reset(new MetricsServer(mMetrics, quint16(metricsPort)));
+        qDebug() << "Metrics served on http://localhost:" << metricsPort << "/metrics";
+    }
+
+    mWebSocket.open(mServerUrl);
 }
 
 MainWindow::~MainWindow()
 {
-
+    dumpLatencies();
+    Trace::stop();
 }
 
 void MainWindow::error(QAbstractSocket::SocketError err)
@@ -69,127 +151,71 @@ void MainWindow::error(QAbstractSocket::SocketError err)
 void MainWindow::connected()
 {
     qDebug() << "Socket connected";
-    connect(&mWebSocket, &QWebSocket::textMessageReceived, this, &MainWindow::messageReceived);
-    mWebSocket.sendTextMessage("{\"type\":\"get_board\"}");
+    mReconnectDelay = 500;
+    mSession.start();
 }
 
-void MainWindow::messageReceived(QString msg)
+void MainWindow::disconnected()
 {
-    QJsonDocument doc = QJsonDocument::fromJson(msg.toUtf8());
-    if(doc.isNull()){
-        qDebug() << "Error while parsing json";
-        return;
-    }
-
-    QJsonValue v = doc.object()["type"];
+    qWarning() << "Socket disconnected, reconnecting in" << mReconnectDelay << "ms";
+    mReconnectTimer.start(mReconnectDelay);
+    mReconnectDelay = std::min(mReconnectDelay * 2, 8000);
+}
 
-    int msgId = doc.object()["id"].toInt();
+void MainWindow::reconnect()
+{
+    mWebSocket.open(mServerUrl);
+}
 
-    if(mPrevMsgId > -1){
-        if(msgId > mPrevMsgId +1){
-            qWarning() << "Skipped a message prev = " << mPrevMsgId << " new = " << msgId << "\n";
-        }else{
-            mPrevMsgId = msgId;
-        }
+void MainWindow::dumpLatencies()
+{
+    const TurnLatencies &latencies = mSession.getLatencies();
+    if(latencies.total.getCount() == mDumpedTurns)return;
+    mDumpedTurns = latencies.total.getCount();
+
+    QJsonObject line = latencies.toJson();
+    line["time"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    QByteArray json = QJsonDocument(line).toJson(QJsonDocument::Compact);
+    if(mLatencyLog.isEmpty()){
+        qDebug().noquote() << "Turn latencies (microseconds) :" << json;
+        return;
     }
 
-    if(!v.isString())return;
-    QString str = v.toString();
-
-    if(str == "get_board"){
-        updateBoard(doc.object()["data"].toArray());
-    }else if(str == "your_id"){
-        mId = doc.object()["data"].toInt();
-        mPrevMsgId = msgId;
-        qDebug() << "Setting mPrevMsgId\n";
-        mBattleField.setId(mId);
-    }else if(str == "your_turn"){
-        play();
-    }else if(str == "move"){
-        //apply move
-        QJsonObject data = doc.object()["data"].toObject();
-        Coordinates from(data["from"].toObject());
-        Coordinates to(data["to"].toObject());
-
-
-        move(from, to);
-
-    }else if(str == "attack"){
-        //apply attack
-        QJsonObject data = doc.object()["data"].toObject();
-        Coordinates from(data["from"].toObject());
-        Coordinates to(data["to"].toObject());
-
-        attack(from, to);
-    }else if(str == "you_win"){
-        QMessageBox::information(this,"You win","You win this game, congratulations", QMessageBox::Ok);
-    }else if(str == "you_loose"){
-        QMessageBox::information(this,"You loose", "You lost this game, sad :(",QMessageBox::Ok);
+    QFile log(mLatencyLog);
+    if(log.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)){
+        log.write(json + "\n");
+    }else{
+        qWarning() << "Could not write the latencies to" << mLatencyLog;
     }
-
 }
 
-void MainWindow::move(const Coordinates &from, const Coordinates &to)
+void MainWindow::messageReceived(QString msg)
 {
-    mBattleField.move(from, to);
-
-    mButtons[from.y][from.x]->setText("-");
-    mButtons[from.y][from.x]->setStyleSheet("");
-
-    mButtons[to.y][to.x]->setText(mBattleField.unitAt(to)->strType());
-    if(mBattleField.unitAt(to)->getColor() == mId){
-        mButtons[to.y][to.x]->setStyleSheet("QPushButton{color:blue;}");
-    }
+    mSession.messageReceived(msg);
 }
 
-void MainWindow::play()
+void MainWindow::send(const QJsonObject &message)
 {
-    Tree decisionTree;
-
-    std::size_t treeDepth = 2/log10(mBattleField.numberOfUnits()); // depth depending on number of units
-
-    treeDepth = std::min(treeDepth, (std::size_t)5);//max treedepth is five
-
-    decisionTree.generate(treeDepth, mBattleField);
+    mWebSocket.sendTextMessage(QString::fromUtf8(QJsonDocument(message).toJson(QJsonDocument::Compact)));
+}
 
-    decisionTree.getBestAction().sendToSocket(mWebSocket);
+void MainWindow::boardChanged()
+{
+    qDebug().noquote().nospace() << mSession.getBattleField();
 
-    mWebSocket.sendTextMessage("{\"type\":\"end_turn\"}");
+    mBoard->refresh();
 }
 
-void MainWindow::attack(const Coordinates &from, const Coordinates &to)
+void MainWindow::squareChanged(const Coordinates &coords)
 {
-    mBattleField.attack(from, to);
-
-    mButtons[to.y][to.x]->setText("-");
-    mButtons[to.y][to.x]->setStyleSheet("");
+    mBoard->refreshSquare(coords);
 }
 
-void MainWindow::updateBoard(QJsonArray arr)
+void MainWindow::gameOver(bool won)
 {
-    mBattleField.fillField(arr);
-
-    qDebug().noquote().nospace() << mBattleField;
-
-    for(int y = 0; y < 25; ++y){
-        for(int x = 0; x < 25; ++x){
-            QPushButton *button = new QPushButton("-");
-
-            connect(button, &QPushButton::clicked, [=](){
-                qDebug() << "(x:"<<x<<", y "<<y<<")\n";//print the coordinates of a button when clicked
-            });
-
-            mButtons[y][x] = button;
-            button->setMinimumWidth(30);
-            auto &ptr = mBattleField.getField()[y][x];
-            if(ptr){
-                button->setText(ptr->strType());
-                if(ptr->getColor() == mId){
-                    button->setStyleSheet("QPushButton{color : blue;}");
-                }
-            }
-            mLayout->addWidget(button, y, x);
-        }
+    if(won){
+        QMessageBox::information(this,"You win","You win this game, congratulations", QMessageBox::Ok);
+    }else{
+        QMessageBox::information(this,"You loose", "You lost this game, sad :(",QMessageBox::Ok);
     }
-    mWebSocket.sendTextMessage("{\"type\":\"is_ready\"}");
 }
@@ -33,19 +33,22 @@
 
 #include <QMainWindow>
 #include <QWebSocket>
- #include <QJsonObject>
-#include <battlefield.hpp>
-#include <QGridLayout>
-#include <array>
-#include <QPushButton>
+#include <QJsonObject>
+#include "BoardWidget.hpp"
+#include "gamesession.hpp"
+#include "metricsserver.hpp"
+#include <QTimer>
+#include <QUrl>
+#include <memory>
 
 /**
  * @brief The MainWindow class
  * MainWindow is the class used to represent
  * the main window of the application
- * it also handles the websocket communications with the server
+ * it also handles the websocket communications with the server,
+ * the game itself is handled by the game session
  */
-class MainWindow : public QMainWindow
+class MainWindow : public QMainWindow, private GameSession::Listener
 {
     Q_OBJECT
 
@@ -74,39 +77,51 @@ public slots:
      */
     void error(QAbstractSocket::SocketError err);
 
+    /**
+     * @brief disconnected whenever
+     * the socket lost the connection to the server,
+     * schedules a reconnection
+     */
+    void disconnected();
+
+    /**
+     * @brief reconnect tries to open the socket again
+     * the state of the game will be resynchronized
+     * as soon as the socket is connected
+     */
+    void reconnect();
+
+    /**
+     * @brief dumpLatencies writes the latency histograms of the turns
+     * (if turns were played since the last dump), as a json line
+     * appended to the latency log, or to the debug output without log
+     */
+    void dumpLatencies();
+
 private:
     /**
-     * @brief updateBoard
-     * updates the board, using the given json array
-     * that is : updating the battlefield, and updating the buttons
-     * @param arr
+     * @brief send sends the message of the session
+     * through the websocket
+     * @param message
      */
-    void updateBoard(QJsonArray arr);
+    void send(const QJsonObject &message) override;
 
     /**
-     * @brief move whenever a move action is sent by the socket
-     * performs the move, on the field, then update
-     * the buttons
-     * @param from
-     * @param to
+     * @brief boardChanged repaints the whole board
      */
-    void move(const Coordinates &from, const Coordinates &to);
+    void boardChanged() override;
 
     /**
-     * @brief attack whenever an attack action is sent by the socket
-     * performs the attacke, on the field then update the buttons
-     * @param from
-     * @param to
+     * @brief squareChanged repaints the square
+     * @param coords
      */
-    void attack(const Coordinates &from, const Coordinates &to);
+    void squareChanged(const Coordinates &coords) override;
 
     /**
-     * @brief play
-     * when it's the player's turn to make a move
-     * will calculate the best move and send it to the
-     * server via websocket
+     * @brief gameOver tells the player who won
+     * @param won
      */
-    void play();
+    void gameOver(bool won) override;
 
     /**
      * @brief mWebSocket
@@ -116,37 +131,63 @@ private:
     QWebSocket mWebSocket;
 
     /**
-     * @brief mBattleField the
-     * battlefield
+     * @brief mMetrics metrics of the session (declared before
+     * the session, which removes itself from it)
      */
-    BattleField mBattleField;
+    MetricsRegistry mMetrics;
 
     /**
-     * @brief mLayout layout
+     * @brief mSession the game (battlefield, engine
+     * and record)
      */
-    QGridLayout *mLayout;
+    GameSession mSession;
 
     /**
-     * @brief mButtons a pointer to all the buttons
-     * to display the battle field. Used to update them
-     * whenever it's necessary.
-     * When clicking on a button, the coordinate of it
+     * @brief mBoard widget displaying the battle field,
+     * repainted whenever it's necessary.
+     * When clicking on a square, its coordinates
      * will be printed out
-     * all the pointers are automatically destroyed by Qt
-     * so no need to handle their destruction
+     * it is owned by the window (destroyed by Qt)
+     */
+    BoardWidget *mBoard;
+
+    /**
+     * @brief mServerUrl url of the server, kept
+     * to be able to reconnect
+     */
+    QUrl mServerUrl;
+
+    /**
+     * @brief mReconnectTimer timer used to wait
+     * before trying to reconnect to the server
+     */
+    QTimer mReconnectTimer;
+
+    /**
+     * @brief mReconnectDelay delay before the next reconnection
+     * attempt (in ms), doubled after each failed attempt
+     */
+    int mReconnectDelay = 500;
+
+    /**
+     * @brief mLatencyTimer timer used to dump the latencies periodically
+     */
+    QTimer mLatencyTimer;
+
+    /**
+     * @brief mLatencyLog file the latencies are appended to (may be empty)
      */
-    std::array<std::array<QPushButton*, 25>, 25> mButtons;
+    QString mLatencyLog;
 
     /**
-     * @brief mId id of the player
+     * @brief mDumpedTurns number of turns at the last dump
      */
-    int mId;
+    quint64 mDumpedTurns = 0;
 
     /**
-     * @brief mPrevMsgId id of the previous message
-     * to be sure the message arrive in order
+     * @brief mMetricsServer serves the metrics (only if GUERRILLA_METRICS_PORT is set)
      */
-    int mPrevMsgId = -1;
+    std::unique_ptr<MetricsServer> mMetricsServer;
 };
 
 #endif // MAINWINDOW_HPP
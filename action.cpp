@@ -62,22 +62,12 @@ QJsonObject Action::toJson() const
 
 
 
-void Turn::applyActions(BattleField &field)
+void Turn::applyActions(BattleField &field) const
 {
     if(mActions.first)field.applyAction(*mActions.first);
     if(mActions.second)field.applyAction(*mActions.second);
 }
 
-void Turn::sendToSocket(QWebSocket &socket) const
-{
-    if(!mActions.first)return;
-    socket.sendTextMessage(mActions.first->toString());
-
-    if(!mActions.second)return;
-    socket.sendTextMessage(mActions.second->toString());
-
-}
-
 void Turn::addAction(const std::shared_ptr<Action> &nwAction)
 {
     if(mActions.second)return;//already full
@@ -100,7 +90,7 @@ float Turn::getWeight() const
     return tot;
 }
 
-const std::shared_ptr<Action> &Turn::getAction(quint8 index)
+const std::shared_ptr<Action> &Turn::getAction(quint8 index) const
 {
     if(index > 2)throw std::out_of_range("Greater than 2");
 
@@ -113,3 +103,25 @@ bool Turn::hasAttack() const
             (mActions.second && mActions.second->getType() == Action::ATTACK);
 
 }
+
+quint32 Turn::pack() const
+{
+    if(!mActions.first)return 0;
+
+    return pack(mActions.first->getFrom().index(), mActions.first->getTo().index(),
+                mActions.second ? mActions.second->getTo().index() : -1);
+}
+
+Turn Turn::unpack(quint32 packed)
+{
+    if(!packed)return Turn();
+
+    Coordinates from = Coordinates::fromIndex(packed & 0x3FF);
+    Coordinates to = Coordinates::fromIndex((packed >> 10) & 0x3FF);
+    Turn turn(std::make_shared<Action>(Action::MOVE, from, to));
+
+    if(packed & (1u << 20)){
+        turn.addAction(std::make_shared<Action>(Action::ATTACK, to, Coordinates::fromIndex(packed >> 21)));
+    }
+    return turn;
+}
@@ -34,7 +34,6 @@
 
 #include <QJsonObject>
 #include <QJsonDocument>
-#include <qwebsocket.h>
 #include "coordinates.hpp"
 #include <memory>
 
@@ -199,13 +198,7 @@ public:
      * @brief applyActions execute all the actions on the given field
      * @param field
      */
-    void applyActions(BattleField &field);
-
-    /**
-     * @brief sendToSocket send the actions to the given websocket
-     * @param socket
-     */
-    void sendToSocket(QWebSocket &socket) const;
+    void applyActions(BattleField &field) const;
 
     /**
      * @brief addAction add an action to this turn,
@@ -226,7 +219,7 @@ public:
      * @param index
      * @return
      */
-    const std::shared_ptr<Action> &getAction(quint8 index);
+    const std::shared_ptr<Action> &getAction(quint8 index) const;
 
     /**
      * @brief hasAttack wether this turn contains an attack action
@@ -234,6 +227,37 @@ public:
      */
     bool hasAttack() const;
 
+    /**
+     * @brief pack packs the turn in 32 bits
+     * (used to save turns in files and tables).
+     * The turn must be a move, optionally followed by an attack
+     * from the destination of the move.
+     * An empty turn is packed as 0
+     * @return
+     */
+    quint32 pack() const;
+
+    /**
+     * @brief pack packs a turn without creating it
+     * @param from index of the field the unit moves from
+     * @param to index of the field the unit moves to
+     * @param target index of the field attacked after the move (-1 : no attack)
+     * @return the same value as the pack() of the turn
+     */
+    static quint32 pack(quint16 from, quint16 to, int target = -1)
+    {
+        quint32 packed = from | (quint32(to) << 10);
+        if(target >= 0)packed |= (1u << 20) | (quint32(target) << 21);
+        return packed;
+    }
+
+    /**
+     * @brief unpack creates the turn packed with pack()
+     * @param packed
+     * @return
+     */
+    static Turn unpack(quint32 packed);
+
 
 private:
     /**
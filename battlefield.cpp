@@ -29,19 +29,28 @@
  * Created on 30/1/2018
  */
 #include "battlefield.hpp"
+#include "zobrist.hpp"
+#include "targets.hpp"
+#include "trace.hpp"
 #include <qjsonarray.h>
 #include <qjsonvalue.h>
 
 BattleField::BattleField()
 {
-
+    resetHashes();
 }
 
 BattleField::BattleField(const BattleField &other):
-    myId(other.getId())
+    myId(other.getId()),
+    mHashes(other.mHashes),
+    mUnitCounts(other.mUnitCounts),
+    mThreats(other.mThreats),
+    mNetwork(other.mNetwork),
+    mAccumulator(other.mAccumulator)
 {
-    for(int y = 0; y < 25; ++y){
-        for(int x = 0; x < 25; ++x){
+    GUERRILLA_TRACE("BattleField copy");
+    for(int y = 0; y < Geometry::HEIGHT; ++y){
+        for(int x = 0; x < Geometry::WIDTH; ++x){
             if(other.getField()[y][x]){
                 std::shared_ptr<Unit> unitCopy = std::shared_ptr<Unit>(other.getField()[y][x]->clone());
                 mField[y][x] = unitCopy;
@@ -61,9 +70,17 @@ void BattleField::fillField(const QJsonArray &units)
         QJsonObject coordinates = obj["coordinates"].toObject();
         int x = coordinates["x"].toInt();
         int y = coordinates["y"].toInt();
+        if(!Coordinates(x, y).isValid()){
+            qWarning() << "Unit outside of the battlefield (x:" << x << ", y:" << y << ")";
+            continue;
+        }
 
         std::shared_ptr<Unit> shU = Unit::fromJson(obj.value("pawn").toObject(), Coordinates(x,y));
         mField[y][x] = shU;
+        hashUnit(*shU);
+        ++mUnitCounts[shU->getColor()][shU->getType()];
+        addThreats(*shU, 1);
+        if(mNetwork)mNetwork->addUnit(mAccumulator, *shU);
 
         if(shU->getColor() == myId){
             mMyUnits << shU;
@@ -73,29 +90,97 @@ void BattleField::fillField(const QJsonArray &units)
     }
 }
 
+QJsonArray BattleField::toJson() const
+{
+    QJsonArray units;
+    for(const std::shared_ptr<Unit> &unit : mAllUnits){
+        QJsonObject pawn;
+        pawn["color"] = unit->getColor();
+        pawn["type"] = unit->getType();
+
+        QJsonObject obj;
+        obj["coordinates"] = unit->getPosition().toJsonObjet();
+        obj["pawn"] = pawn;
+        units.append(obj);
+    }
+    return units;
+}
 
 void BattleField::clearField()
 {
     mField = battle_field();
+    mAllUnits.clear();
+    mMyUnits.clear();
+    resetHashes();
+    mUnitCounts = {};
+    mThreats = {};
+    if(mNetwork)mNetwork->refresh(*this, mAccumulator);
+}
+
+void BattleField::resetHashes()
+{
+    for(int symmetry = 0; symmetry < Symmetry::COUNT; ++symmetry){
+        //the flips swap the side to play
+        mHashes[symmetry] = (myId == Unit::BLACK) != bool(symmetry & Symmetry::FLIP) ? Zobrist::sideKey() : 0;
+    }
+}
+
+void BattleField::setId(int nwId)
+{
+    if((myId == Unit::BLACK) != (nwId == Unit::BLACK)){
+        for(quint64 &hash : mHashes)hash ^= Zobrist::sideKey();
+    }
+    myId = nwId;
+
+    mMyUnits.clear();
+    for(const std::shared_ptr<Unit> &unit : mAllUnits){
+        if(unit->getColor() == myId){
+            mMyUnits << unit;
+        }
+    }
 }
 
 
 void BattleField::move(const Coordinates &from, const Coordinates &to)
 {
-    mField[from.y][from.x]->move(to);
+    Unit &moving = *mField[from.y][from.x];
+    hashUnit(moving);
+    addThreats(moving, -1);
+    moving.move(to);
+    hashUnit(moving);
+    addThreats(moving, 1);
+    if(mNetwork)mNetwork->moveUnit(mAccumulator, moving, from.index(), to.index());
     mField[to.y][to.x] = mField[from.y][from.x];
     mField[from.y][from.x] = {};
 }
 
+void BattleField::setNetwork(const Network *network)
+{
+    mNetwork = network;
+    if(mNetwork)mNetwork->refresh(*this, mAccumulator);
+}
+
 void BattleField::attack(const Coordinates &from, const Coordinates &to)
 {
     Q_UNUSED(from);
     const std::shared_ptr<Unit> &killed = mField[to.y][to.x];
+    hashUnit(*killed);
+    --mUnitCounts[killed->getColor()][killed->getType()];
+    addThreats(*killed, -1);
+    if(mNetwork)mNetwork->removeUnit(mAccumulator, *killed);
     mAllUnits.removeAll(killed);//delete reference of the pointer
     mMyUnits.removeAll(killed);
     mField[to.y][to.x] = {};
 }
 
+void BattleField::addThreats(const Unit &unit, int delta)
+{
+    std::array<quint8, Geometry::SIZE> &threats = mThreats[unit.getColor()];
+    for(quint16 target : Targets::threats(unit.getType(), unit.getColor(), unit.getPosition().index())){
+        threats[target] += delta;
+    }
+}
+
 const std::shared_ptr<Unit>& BattleField::unitAt(const Coordinates &coords) const
 {
     if(!coords.isValid())return mEmpty;
@@ -103,32 +188,24 @@ const std::shared_ptr<Unit>& BattleField::unitAt(const Coordinates &coords) cons
 }
 
 
-float BattleField::actionWeight(const Action &action) const
+float BattleField::unitValue(Unit::TYPE type)
 {
-    if(action.getType() == Action::ATTACK){
-        //depending on the type of unit, different points
-        auto &target = unitAt(action.getTo());
-        if(target->strType() == "S")return 200.f; // attacking mobile tower
-        if(target->strType() == "R")return 10.f; // attacking gunner
-        if(target->strType() == "L") return 50.f; // attacking infantery
-    }else{
-        //random value for each move
-        return qrand()%25;
-
-        //depending on the position on the board
-        // other strategy : get closer to the end
-        auto &moving = unitAt(action.getFrom());
-        if(moving->getColor() == Unit::WHITE)return action.getTo().y;
-        return 25-action.getTo().y;
+    switch(type){
+    case Unit::MOBILE_TOWER:
+        return 200.f;
+    case Unit::INFANTERY:
+        return 50.f;
+    default:
+        return 10.f;
     }
 }
 
 std::vector<Turn> BattleField::possibleTurns() const
 {
+    GUERRILLA_TRACE("possibleTurns");
     std::vector<Turn> vec;
-    for(std::shared_ptr<Unit> munit : mMyUnits){
-        auto res = munit->possibleTurns(*this);
-        vec.insert(vec.end(), res.begin(), res.end());
+    for(const std::shared_ptr<Unit> &munit : mMyUnits){
+        munit->possibleTurns(*this, vec);
     }
     return vec;
 }
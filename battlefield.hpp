@@ -36,13 +36,17 @@
 #include <unit.hpp>
 #include <qdebug.h>
 #include <qvector.h>
+#include <QJsonArray>
 #include <vector>
 
 #include "coordinates.hpp"
 #include "action.hpp"
+#include "network.hpp"
+#include "symmetry.hpp"
+#include "zobrist.hpp"
 
 
-using battle_field = std::array<std::array<std::shared_ptr<Unit> ,25 >, 25>;
+using battle_field = std::array<std::array<std::shared_ptr<Unit>, Geometry::WIDTH>, Geometry::HEIGHT>;
 
 /**
  * @brief The BattleField class
@@ -66,11 +70,46 @@ public:
     BattleField(const BattleField &other);
 
     /**
-     * @brief actionWeight calculates the weight of an action
-     * @param action
+     * @brief unitValue
+     * @param type
+     * @return the value of a unit of the given type
+     * (the weight of an attack on it)
+     */
+    static float unitValue(Unit::TYPE type);
+
+    /**
+     * @brief unitCount
+     * @param color
+     * @param type
+     * @return the number of units of the given color and type
+     * (updated on each attack, the field is evaluated with it)
+     */
+    int unitCount(Unit::COLOR color, Unit::TYPE type) const
+    {
+        return mUnitCounts[color][type];
+    }
+
+    /**
+     * @brief getMyUnits getter for the units of the player
      * @return
      */
-    float actionWeight(const Action &action) const;
+    const QVector<std::shared_ptr<Unit>> &getMyUnits() const
+    {
+        return mMyUnits;
+    }
+
+    /**
+     * @brief memoryUsage approximation of the bytes held by the field :
+     * itself, its units (each one with the control block of its pointer)
+     * and its lists of units
+     * @return
+     */
+    std::size_t memoryUsage() const
+    {
+        return sizeof(BattleField) +
+                mAllUnits.size() * (sizeof(Unit) + 3 * sizeof(void*)) +
+                (mAllUnits.capacity() + mMyUnits.capacity()) * sizeof(std::shared_ptr<Unit>);
+    }
 
     /**
      * @brief fillField fills field with the units
@@ -79,6 +118,13 @@ public:
      */
     void fillField(const QJsonArray &units);
 
+    /**
+     * @brief toJson the units of the field, in the
+     * format of the server (the opposite of fillField)
+     * @return
+     */
+    QJsonArray toJson() const;
+
     /**
      * @brief clearField removes all the units
      * from the field
@@ -103,6 +149,18 @@ public:
      */
     const std::shared_ptr<Unit> &unitAt(const Coordinates &coords) const;
 
+    /**
+     * @brief unitAt returns the unit at the given field index
+     * (y * width + x), the index is not checked : it must come from
+     * a valid coordinate (for example from the target tables)
+     * @param index
+     * @return
+     */
+    const std::shared_ptr<Unit> &unitAt(int index) const
+    {
+        return mField[index / Geometry::WIDTH][index % Geometry::WIDTH];
+    }
+
     /**
      * @brief attack performs an attack from the given coordinate
      * to the target coordinates
@@ -137,11 +195,10 @@ public:
 
     /**
      * @brief setId setter for the id
+     * (the player's units are updated accordingly)
      * @param nwId
      */
-    void setId(int nwId){
-        myId = nwId;
-    }
+    void setId(int nwId);
 
     /**
      * @brief isAccessible
@@ -190,8 +247,111 @@ public:
         return mAllUnits.size();
     }
 
+    /**
+     * @brief numberOfMyUnits the number of units
+     * of the player that has to play
+     * @return
+     */
+    int numberOfMyUnits() const
+    {
+        return mMyUnits.size();
+    }
+
+    /**
+     * @brief getUnits getter for all the units
+     * alive on the field
+     * @return
+     */
+    const QVector<std::shared_ptr<Unit>> &getUnits() const
+    {
+        return mAllUnits;
+    }
+
+    /**
+     * @brief hash zobrist hash of the battlefield
+     * (units and side to play), updated on each move/attack
+     * @return
+     */
+    quint64 hash() const
+    {
+        return mHashes[Symmetry::IDENTITY];
+    }
+
+    /**
+     * @brief canonicalHash the same hash for all the symmetric
+     * battlefields (the lowest of their hashes)
+     * @param symmetry set to the symmetry turning this battlefield into
+     * the canonical one (and back, see Symmetry)
+     * @param mirror wether the mirrored battlefields count (otherwise
+     * only the flipped one shares the hash)
+     * @return
+     */
+    quint64 canonicalHash(int &symmetry, bool mirror = true) const
+    {
+        symmetry = Symmetry::IDENTITY;
+        for(int other = mirror ? Symmetry::MIRROR : Symmetry::FLIP; other < Symmetry::COUNT; other += mirror ? 1 : 2){
+            if(mHashes[other] < mHashes[symmetry])symmetry = other;
+        }
+        return mHashes[symmetry];
+    }
+
+    /**
+     * @brief threats
+     * @param color
+     * @param target valid coordinates
+     * @return the number of units of the given color that can
+     * attack the target during their turn (after a move, whether the
+     * field they need to move to is free or not).
+     * The counts are updated on each move/attack
+     */
+    int threats(Unit::COLOR color, const Coordinates &target) const
+    {
+        return mThreats[color][target.index()];
+    }
+
+    /**
+     * @brief isThreatened
+     * @param unit
+     * @return wether an opponent's unit can attack the given unit
+     */
+    bool isThreatened(const Unit &unit) const
+    {
+        return mThreats[1 - unit.getColor()][unit.getPosition().index()] > 0;
+    }
+
+    /**
+     * @brief setNetwork the accumulator of the given evaluation
+     * network is computed, then updated on each move/attack
+     * (and in the copies of the field)
+     * @param network the network (nullptr : no accumulator)
+     */
+    void setNetwork(const Network *network);
+
+    const Network *getNetwork() const
+    {
+        return mNetwork;
+    }
+
+    /**
+     * @brief getAccumulator the first layer of the network
+     * (only meaningful with a network)
+     * @return
+     */
+    const Network::Accumulator &getAccumulator() const
+    {
+        return mAccumulator;
+    }
+
 private:
 
+    /**
+     * @brief addThreats adds (or removes) the fields the
+     * given unit can attack to the threats of its color
+     * @param unit
+     * @param delta 1 to add the threats, -1 to remove them
+     */
+    void addThreats(const Unit &unit, int delta);
+
     /**
      * @brief mEmpty
      * empty pointer, when an invalid unit
@@ -222,6 +382,44 @@ private:
     * @brief myId id of ther player
     */
     int myId = -1;
+
+    /**
+     * @brief mHashes zobrist hash of the battlefield, and of
+     * the battlefields it becomes with each symmetry
+     */
+    std::array<quint64, Symmetry::COUNT> mHashes = {};
+
+    /**
+     * @brief resetHashes the hashes of the battlefield without units
+     */
+    void resetHashes();
+
+    /**
+     * @brief hashUnit adds (or removes) the unit to the hashes
+     * @param unit
+     */
+    void hashUnit(const Unit &unit)
+    {
+        for(int symmetry = 0; symmetry < Symmetry::COUNT; ++symmetry)mHashes[symmetry] ^= Zobrist::unitKey(symmetry, unit);
+    }
+
+    /**
+     * @brief mUnitCounts the number of units of each color and type
+     */
+    std::array<std::array<quint16, 3>, 2> mUnitCounts = {};
+
+    /**
+     * @brief mThreats for each color, the number of its units
+     * that can attack each field
+     */
+    std::array<std::array<quint8, Geometry::SIZE>, 2> mThreats = {};
+
+    /**
+     * @brief mNetwork the network whose accumulator is updated (may be null)
+     */
+    const Network *mNetwork = nullptr;
+
+    Network::Accumulator mAccumulator;
 };
 
 /**
@@ -232,8 +430,8 @@ private:
  */
 inline QDebug operator<<(QDebug debug, const BattleField &field)
 {
-    for(int y = 0; y < 25; ++y){
-        for(int x = 0; x < 25; ++x){
+    for(int y = 0; y < Geometry::HEIGHT; ++y){
+        for(int x = 0; x < Geometry::WIDTH; ++x){
             if(field.getField()[y][x]){
                 debug << *field.getField()[y][x];
             }else{
@@ -0,0 +1,101 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/*
+ * File:   boardsync.cpp
+ * Author: azarias
+ *
+ * Created on 14/3/2018
+ */
+#include "boardsync.hpp"
+
+#include <QDebug>
+#include <QJsonArray>
+
+void BoardSync::connected()
+{
+    mPrevMsgId = -1;
+    mSyncing = false;
+}
+
+BoardSync::EVENT BoardSync::received(const QJsonObject &message, bool &resync)
+{
+    resync = false;
+    const QString type = message["type"].toString();
+    const int msgId = message["id"].toInt();
+    const bool hasId = message.contains("id");
+
+    //the id and the board are never dropped : their id is
+    //where the messages start again (after a reconnection)
+    if(type == "your_id"){
+        if(hasId)mPrevMsgId = msgId;
+        mField.setId(message["data"].toInt());
+        return ID;
+    }else if(type == "get_board"){
+        if(hasId)mPrevMsgId = msgId;
+        mSyncing = false;
+        mField.clearField();
+        mField.fillField(message["data"].toArray());
+        return BOARD;
+    }
+
+    if(mPrevMsgId > -1 && hasId){
+        if(msgId <= mPrevMsgId){
+            return IGNORED;//already received (resent after a reconnection)
+        }else if(msgId > mPrevMsgId +1 && !mSyncing){
+            qWarning() << "Skipped a message prev = " << mPrevMsgId << " new = " << msgId << ", resynchronizing\n";
+            resync = true;
+            mSyncing = true;
+        }
+        mPrevMsgId = msgId;
+    }
+
+    if(!message["type"].isString())return IGNORED;
+
+    if(type == "your_turn"){
+        return TURN;
+    }else if(type == "move" || type == "attack"){
+        if(mSyncing)return IGNORED;//the coming board already contains it
+        QJsonObject data = message["data"].toObject();
+        mFrom = Coordinates(data["from"].toObject());
+        mTo = Coordinates(data["to"].toObject());
+
+        //our board does not match the server's one
+        const bool fits = type == "move" ? mField.unitAt(mFrom) && !mField.unitAt(mTo) : bool(mField.unitAt(mTo));
+        if(!fits){
+            resync = true;
+            mSyncing = true;
+            return IGNORED;
+        }
+
+        if(type == "move"){
+            mField.move(mFrom, mTo);
+            return MOVED;
+        }
+        mField.attack(mFrom, mTo);
+        return ATTACKED;
+    }else if(type == "you_win" || type == "you_loose"){
+        return type == "you_win" ? WON : LOST;
+    }
+    return OTHER;
+}
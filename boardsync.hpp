@@ -0,0 +1,138 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/*
+ * File:   boardsync.hpp
+ * Author: azarias
+ *
+ * Created on 14/3/2018
+ */
+#ifndef BOARDSYNC_HPP
+#define BOARDSYNC_HPP
+
+#include <QJsonObject>
+
+#include "battlefield.hpp"
+
+/**
+ * @brief The BoardSync class
+ * the rules the client follows to keep its battlefield in line with
+ * the messages of the server : the messages resent after a reconnection
+ * are dropped, a gap in the ids or a move that does not fit the board
+ * asks for the board again, and the moves received meanwhile are ignored.
+ * The client and the tools reading its records follow the same rules
+ */
+class BoardSync
+{
+public:
+    /**
+     * @brief The EVENT enum what a received message did
+     */
+    enum EVENT {
+        IGNORED,//no type, already received, or a move while the board is asked
+        ID,//your_id, the id of the field is set
+        BOARD,//get_board, the field is filled
+        TURN,//your_turn
+        MOVED,//a move was applied (see getFrom/getTo)
+        ATTACKED,//an attack was applied
+        WON,
+        LOST,
+        OTHER//any other message
+    };
+
+    /**
+     * @brief connected to call on each connection : the server
+     * may number its messages from scratch
+     */
+    void connected();
+
+    /**
+     * @brief boardRequested to call when get_board is sent,
+     * the moves are ignored until the board arrives
+     */
+    void boardRequested()
+    {
+        mSyncing = true;
+    }
+
+    /**
+     * @brief received handles a message of the server
+     * @param message
+     * @param resync set to wether the board must be asked again
+     * (a message was skipped, or a move does not fit the board)
+     * @return what the message did
+     */
+    EVENT received(const QJsonObject &message, bool &resync);
+
+    /**
+     * @brief isSyncing
+     * @return wether a board was asked and not received yet
+     */
+    bool isSyncing() const
+    {
+        return mSyncing;
+    }
+
+    const BattleField &getField() const
+    {
+        return mField;
+    }
+
+    /**
+     * @brief getFrom
+     * @return the origin of the last move or attack
+     */
+    const Coordinates &getFrom() const
+    {
+        return mFrom;
+    }
+
+    /**
+     * @brief getTo
+     * @return the destination (or target) of the last move or attack
+     */
+    const Coordinates &getTo() const
+    {
+        return mTo;
+    }
+
+private:
+    BattleField mField;
+
+    /**
+     * @brief mPrevMsgId id of the previous message
+     * to be sure the message arrive in order
+     */
+    int mPrevMsgId = -1;
+
+    /**
+     * @brief mSyncing wether a board was asked and not received yet
+     */
+    bool mSyncing = false;
+
+    Coordinates mFrom;
+
+    Coordinates mTo;
+};
+
+#endif // BOARDSYNC_HPP
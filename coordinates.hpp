@@ -33,6 +33,8 @@
 
 #include <QJsonObject>
 
+#include "geometry.hpp"
+
 #include  <random>
 #include  <iterator>
 
@@ -54,7 +56,7 @@ struct Coordinates{
      * @brief Coordinates default constructor
      * (init all the valus at 0)
      */
-    Coordinates():
+    constexpr Coordinates():
         x(0),
         y(0)
     {
@@ -67,7 +69,7 @@ struct Coordinates{
      * @param x_
      * @param y_
      */
-    Coordinates(int x_, int y_):
+    constexpr Coordinates(int x_, int y_):
         x(x_),
         y(y_)
     {
@@ -79,15 +81,34 @@ struct Coordinates{
      * @return wether this coordinates is valid
      * relative to the battlefield
      */
-    bool isValid() const{
-        return x >= 0 && y >= 0 && x < 25 && y < 25;
+    constexpr bool isValid() const{
+        return x >= 0 && y >= 0 && x < Geometry::WIDTH && y < Geometry::HEIGHT;
+    }
+
+    /**
+     * @brief index
+     * @return the index of the field pointed by these
+     * coordinates, when the battlefield is seen as
+     * a single line of fields
+     */
+    constexpr int index() const{
+        return y * Geometry::WIDTH + x;
+    }
+
+    /**
+     * @brief fromIndex
+     * @param index
+     * @return the coordinates of the field with the given index
+     */
+    static constexpr Coordinates fromIndex(int index){
+        return Coordinates(index % Geometry::WIDTH, index / Geometry::WIDTH);
     }
 
     /**
      * @brief Coordinates copy constructor
      * @param other
      */
-    Coordinates(const Coordinates &other):
+    constexpr Coordinates(const Coordinates &other):
         x(other.x),
         y(other.y)
     {
@@ -99,7 +120,7 @@ struct Coordinates{
      * @param other
      * @return
      */
-    Coordinates operator+(const Coordinates &other) const
+    constexpr Coordinates operator+(const Coordinates &other) const
     {
         return Coordinates(x + other.x, y + other.y);
     }
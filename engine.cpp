@@ -0,0 +1,146 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   engine.cpp
+ * Author: azarias
+ *
+ * Created on 25/2/2018
+ */
+#include "engine.hpp"
+#include "tree.hpp"
+#include "trace.hpp"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include <algorithm>
+#include <cmath>
+
+const std::size_t Engine::MAX_DEPTH;
+
+Engine::Engine()
+{
+
+}
+
+bool Engine::loadOpeningBook(const QString &path)
+{
+    return mOpeningBook.open(path);
+}
+
+int Engine::loadTablebases(const QString &directory)
+{
+    return mTablebase.load(directory);
+}
+
+bool Engine::loadWeights(const QString &path)
+{
+    return mEvaluation.load(path);
+}
+
+bool Engine::loadNetwork(const QString &path)
+{
+    return mEvaluation.loadNetwork(path);
+}
+
+Turn Engine::play(const BattleField &field)
+{
+    GUERRILLA_TRACE("play");
+    QElapsedTimer timer;
+    timer.start();
+    mLastDecision = Decision();
+    mLastStats = SearchStats();
+    mLastPrincipalVariation.clear();
+
+    Turn knownTurn;
+    if(mTablebase.bestTurn(field, knownTurn)){
+        mLastDecision.source = TABLEBASE;
+    }else if(mOpeningBook.probe(field, knownTurn)){
+        mLastDecision.source = BOOK;
+    }
+    if(mLastDecision.source != NONE){
+        mLastDecision.time = timer.nsecsElapsed() / 1000;
+        return knownTurn;
+    }
+
+    Tree decisionTree(mCache);
+    decisionTree.setTablebase(&mTablebase);
+    decisionTree.setEvaluation(&mEvaluation);
+    decisionTree.setOptions(mOptions);
+    if(mStatsEnabled)decisionTree.setStats(&mLastStats);
+    std::size_t depth = mDepth ? mDepth : mOptions.timeLimit || mOptions.nodeLimit ? MAX_DEPTH : searchDepth(field);
+    decisionTree.generate(depth, field);
+    mLastDecision.depth = decisionTree.getDepth();
+    mLastDecision.stop = decisionTree.getStopReason();
+    mLastDecision.nodes = decisionTree.getNodes();
+    mLastDecision.memory = decisionTree.getPeakMemory();
+    mLastPrincipalVariation = decisionTree.getPrincipalVariation();
+
+    mLastDecision.source = SEARCH;
+    mLastDecision.score = decisionTree.getBestScore();
+    mLastDecision.time = timer.nsecsElapsed() / 1000;
+    if(!mStatsLog.isEmpty())logStats(field, decisionTree.getBestAction());
+    return decisionTree.getBestAction();
+}
+
+void Engine::enableStats(const QString &logPath)
+{
+    mStatsEnabled = true;
+    mStatsLog = logPath;
+}
+
+void Engine::logStats(const BattleField &field, const Turn &turn) const
+{
+    QFile file(mStatsLog);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Append)){
+        qWarning() << "Could not open the search log" << mStatsLog;
+        return;
+    }
+
+    QJsonObject line = mLastStats.toJson();
+    line["hash"] = QString::number(field.hash(), 16);
+    line["player"] = field.getId();
+    line["units"] = field.numberOfUnits();
+    line["turn"] = qint64(turn.pack());
+    line["depth"] = mLastDecision.depth;
+    line["score"] = mLastDecision.score;
+    line["decision_time"] = mLastDecision.time;
+    line["stop"] = SearchOptions::stopName(mLastDecision.stop);
+    QJsonArray pv;
+    for(const Turn &pvTurn : mLastPrincipalVariation)pv.append(qint64(pvTurn.pack()));
+    line["pv"] = pv;
+    file.write(QJsonDocument(line).toJson(QJsonDocument::Compact));
+    file.write("\n");
+}
+
+std::size_t Engine::searchDepth(const BattleField &field)
+{
+    // depth depending on number of units, between one and five
+    int units = field.numberOfUnits();
+    return units > 1 ? std::max(1.0, std::min(2/log10(units), 5.0)) : 5;
+}
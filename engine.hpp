@@ -0,0 +1,280 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   engine.hpp
+ * Author: azarias
+ *
+ * Created on 25/2/2018
+ */
+#ifndef ENGINE_HPP
+#define ENGINE_HPP
+
+#include <QString>
+
+#include "action.hpp"
+#include "battlefield.hpp"
+#include "evaluation.hpp"
+#include "openingbook.hpp"
+#include "searchcache.hpp"
+#include "searchoptions.hpp"
+#include "searchstats.hpp"
+#include "tablebase.hpp"
+
+/**
+ * @brief The Engine class
+ * the bot of a game : chooses the turn to play
+ * using the tablebases, the opening book, or the search.
+ * It lives as long as the game, so that the search
+ * cache is kept from one turn to another
+ */
+class Engine
+{
+public:
+    /**
+     * @brief The SOURCE enum where the turn played comes from
+     */
+    enum SOURCE {NONE, TABLEBASE, BOOK, SEARCH};
+
+    /**
+     * @brief The Decision struct
+     * how the last turn was chosen
+     */
+    struct Decision{
+        SOURCE source = NONE;
+
+        /**
+         * @brief score score of the turn, for the player
+         * (only known for the search)
+         */
+        float score = 0.f;
+
+        /**
+         * @brief depth depth of the search
+         */
+        int depth = 0;
+
+        /**
+         * @brief time time needed to choose the turn, in microseconds
+         */
+        qint64 time = 0;
+
+        /**
+         * @brief stop why the search stopped deepening
+         */
+        SearchOptions::STOP stop = SearchOptions::DEPTH;
+
+        /**
+         * @brief nodes positions searched
+         */
+        quint64 nodes = 0;
+
+        /**
+         * @brief memory most bytes held by the search
+         */
+        std::size_t memory = 0;
+    };
+
+    Engine();
+
+    /**
+     * @brief loadOpeningBook loads the opening book
+     * @param path
+     * @return wether the book was loaded
+     */
+    bool loadOpeningBook(const QString &path);
+
+    /**
+     * @brief loadTablebases loads the tablebases of the given directory
+     * @param directory
+     * @return the number of tables loaded
+     */
+    int loadTablebases(const QString &directory);
+
+    /**
+     * @brief loadWeights loads the weights of the evaluation
+     * (written by Guerrilla-tuner)
+     * @param path
+     * @return wether the weights were loaded
+     */
+    bool loadWeights(const QString &path);
+
+    /**
+     * @brief loadNetwork loads the evaluation network
+     * (it replaces the weights)
+     * @param path
+     * @return wether the network was loaded
+     */
+    bool loadNetwork(const QString &path);
+
+    /**
+     * @brief play chooses the turn to play on the given field
+     * (for the player of the field's id)
+     * @param field
+     * @return the turn (an empty turn if there is no possible turn)
+     */
+    Turn play(const BattleField &field);
+
+    /**
+     * @brief searchDepth the depth of the search,
+     * depending on the number of units on the field (at least one)
+     * @param field
+     * @return
+     */
+    static std::size_t searchDepth(const BattleField &field);
+
+    /**
+     * @brief MAX_DEPTH depth of the search when only
+     * the time or node limit stops it
+     */
+    static const std::size_t MAX_DEPTH = 64;
+
+    /**
+     * @brief setDepth forces the depth of the search
+     * @param depth 0 for a depth depending on the number of units
+     * (or on the time limit of the options, if any)
+     */
+    void setDepth(std::size_t depth)
+    {
+        mDepth = depth;
+    }
+
+    /**
+     * @brief setOptions sets the selective search and the limits
+     * @param options
+     */
+    void setOptions(const SearchOptions &options)
+    {
+        mOptions = options;
+    }
+
+    const SearchOptions &getOptions() const
+    {
+        return mOptions;
+    }
+
+    /**
+     * @brief lastDecision how the turn returned by the
+     * last call to play was chosen
+     * @return
+     */
+    const Decision &lastDecision() const
+    {
+        return mLastDecision;
+    }
+
+    /**
+     * @brief lastPrincipalVariation the turns the last search expects
+     * both players to play, starting with the turn returned
+     * (empty if the turn was not searched)
+     * @return
+     */
+    const std::vector<Turn> &lastPrincipalVariation() const
+    {
+        return mLastPrincipalVariation;
+    }
+
+    /**
+     * @brief enableStats collects the stats of the searches
+     * @param logPath file where the stats of each search are appended,
+     * as one json object per line (nothing is written if empty)
+     */
+    void enableStats(const QString &logPath = QString());
+
+    /**
+     * @brief lastStats stats of the last search
+     * (empty if the stats are not enabled, or if the last
+     * turn was not searched)
+     * @return
+     */
+    const SearchStats &lastStats() const
+    {
+        return mLastStats;
+    }
+
+    /**
+     * @brief getEvaluation the evaluation of the leaves
+     * @return
+     */
+    const Evaluation &getEvaluation() const
+    {
+        return mEvaluation;
+    }
+
+    /**
+     * @brief getCache getter for the search cache
+     * @return
+     */
+    SearchCache &getCache()
+    {
+        return mCache;
+    }
+
+private:
+    OpeningBook mOpeningBook;
+
+    Tablebase mTablebase;
+
+    Evaluation mEvaluation;
+
+    /**
+     * @brief mCache what the previous searches learnt
+     */
+    SearchCache mCache;
+
+    /**
+     * @brief mLastDecision
+     */
+    Decision mLastDecision;
+
+    /**
+     * @brief mDepth forced depth of the search (0 if not forced)
+     */
+    std::size_t mDepth = 0;
+
+    SearchOptions mOptions;
+
+    /**
+     * @brief mStatsEnabled wether the stats of the searches are collected
+     */
+    bool mStatsEnabled = false;
+
+    /**
+     * @brief mStatsLog file where the stats are logged
+     */
+    QString mStatsLog;
+
+    SearchStats mLastStats;
+
+    std::vector<Turn> mLastPrincipalVariation;
+
+    /**
+     * @brief logStats appends the stats of the last search to the log
+     * @param field the field searched
+     * @param turn the turn chosen
+     */
+    void logStats(const BattleField &field, const Turn &turn) const;
+};
+
+#endif // ENGINE_HPP
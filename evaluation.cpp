@@ -0,0 +1,159 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   evaluation.cpp
+ * Author: azarias
+ *
+ * Created on 6/3/2018
+ */
+#include "evaluation.hpp"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+
+const char *groupNames[] = {"material", "threatened"};
+
+const char *typeNames[] = {"mobile_tower", "infantery", "gunner"};
+
+}
+
+Evaluation::Evaluation()
+{
+    mWeights.fill(0.f);
+    for(int type = 0; type < 3; ++type){
+        mWeights[MATERIAL + type] = BattleField::unitValue(static_cast<Unit::TYPE>(type));
+    }
+}
+
+bool Evaluation::load(const QString &path)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))return false;
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if(!doc.isObject())return false;
+
+    const QJsonObject root = doc.object();
+    Features weights = mWeights;
+    for(int feature = 0; feature < FEATURES; ++feature){
+        const QJsonObject group = root[groupNames[feature / 3]].toObject();
+        const QJsonValue value = group[typeNames[feature % 3]];
+        if(value.isDouble())weights[feature] = value.toDouble();
+    }
+    setWeights(weights);
+    return true;
+}
+
+bool Evaluation::save(const QString &path) const
+{
+    QJsonObject root;
+    for(int group = 0; group < FEATURES / 3; ++group){
+        QJsonObject weights;
+        for(int type = 0; type < 3; ++type)weights[typeNames[type]] = mWeights[group * 3 + type];
+        root[groupNames[group]] = weights;
+    }
+
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))return false;
+    return file.write(QJsonDocument(root).toJson()) > 0;
+}
+
+bool Evaluation::loadNetwork(const QString &path)
+{
+    std::shared_ptr<Network> network = std::make_shared<Network>();
+    if(!network->load(path))return false;
+    mNetwork = network;
+    return true;
+}
+
+float Evaluation::evaluate(const BattleField &field) const
+{
+    const int me = field.getId();
+    if(me < 0)return 0.f;
+
+    const Unit::COLOR player = static_cast<Unit::COLOR>(me);
+    const Unit::COLOR opponent = static_cast<Unit::COLOR>(1 - me);
+
+    if(mNetwork){
+        if(field.getNetwork() == mNetwork.get())return mNetwork->evaluate(field.getAccumulator(), player);
+        return mNetwork->evaluate(field, player);
+    }
+
+    float score = 0.f;
+    for(int type = 0; type < 3; ++type){
+        Unit::TYPE t = static_cast<Unit::TYPE>(type);
+        score += mWeights[MATERIAL + type] * (field.unitCount(player, t) - field.unitCount(opponent, t));
+    }
+
+    if(mUseThreats){
+        for(const std::shared_ptr<Unit> &unit : field.getUnits()){
+            if(!field.isThreatened(*unit))continue;
+            float weight = mWeights[THREATENED + unit->getType()];
+            score += unit->getColor() == player ? weight : -weight;
+        }
+    }
+    return score;
+}
+
+void Evaluation::features(const BattleField &field, Features &features)
+{
+    features.fill(0.f);
+    const int me = field.getId();
+    if(me < 0)return;
+
+    for(const std::shared_ptr<Unit> &unit : field.getUnits()){
+        float side = unit->getColor() == me ? 1.f : -1.f;
+        features[MATERIAL + unit->getType()] += side;
+        if(field.isThreatened(*unit))features[THREATENED + unit->getType()] += side;
+    }
+}
+
+quint64 Evaluation::checksum() const
+{
+    if(mNetwork)return mNetwork->checksum();
+
+    //FNV-1a of the weights
+    quint64 hash = 14695981039346656037ULL;
+    const unsigned char *bytes = reinterpret_cast<const unsigned char*>(mWeights.data());
+    for(std::size_t i = 0; i < sizeof(Features); ++i)hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    return hash;
+}
+
+void Evaluation::setWeights(const Features &weights)
+{
+    mWeights = weights;
+    mUseThreats = false;
+    for(int type = 0; type < 3; ++type){
+        if(mWeights[THREATENED + type] != 0.f)mUseThreats = true;
+    }
+}
+
+QString Evaluation::featureName(int feature)
+{
+    return QString("%1.%2").arg(groupNames[feature / 3]).arg(typeNames[feature % 3]);
+}
@@ -0,0 +1,155 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   evaluation.hpp
+ * Author: azarias
+ *
+ * Created on 6/3/2018
+ */
+#ifndef EVALUATION_HPP
+#define EVALUATION_HPP
+
+#include <QString>
+
+#include <array>
+#include <memory>
+
+#include "battlefield.hpp"
+
+/**
+ * @brief The Evaluation class
+ * static evaluation of a battlefield : a weighted sum of features
+ * (material, threatened units), for the player that has to play.
+ * The weights can be fitted to game results by Guerrilla-tuner,
+ * and loaded from a weights file.
+ * When a network is loaded, it evaluates the fields instead of the weights
+ */
+class Evaluation
+{
+public:
+    /**
+     * @brief The FEATURE enum the features of a field, each one
+     * is the difference between the player and the opponent,
+     * for each type of unit (in the order of Unit::TYPE)
+     */
+    enum FEATURE {
+        MATERIAL = 0,//number of units
+        THREATENED = 3,//number of units the opponent can attack
+        FEATURES = 6
+    };
+
+    typedef std::array<float, FEATURES> Features;
+
+    /**
+     * @brief Evaluation default weights : the value of the units,
+     * the threatened units are ignored
+     */
+    Evaluation();
+
+    /**
+     * @brief load loads the weights of the given file
+     * (written by save), the missing weights keep their value
+     * @param path
+     * @return wether the file was read
+     */
+    bool load(const QString &path);
+
+    /**
+     * @brief save writes the weights as json
+     * @param path
+     * @return wether the file was written
+     */
+    bool save(const QString &path) const;
+
+    /**
+     * @brief loadNetwork loads the evaluation network of the given file
+     * @param path
+     * @return wether the file was read
+     */
+    bool loadNetwork(const QString &path);
+
+    /**
+     * @brief getNetwork
+     * @return the evaluation network (null if none was loaded) : the
+     * fields following it (BattleField::setNetwork) are evaluated faster
+     */
+    const Network *getNetwork() const
+    {
+        return mNetwork.get();
+    }
+
+    /**
+     * @brief checksum identifies the evaluation : the hash of
+     * the network if one is loaded, of the weights otherwise
+     * (the scores of two evaluations can't be mixed)
+     * @return
+     */
+    quint64 checksum() const;
+
+    /**
+     * @brief evaluate
+     * @param field
+     * @return the score of the field, for the player that has to play
+     */
+    float evaluate(const BattleField &field) const;
+
+    /**
+     * @brief features computes the features of the given field
+     * (evaluate is the sum of the features times the weights)
+     * @param field
+     * @param features
+     */
+    static void features(const BattleField &field, Features &features);
+
+    const Features &getWeights() const
+    {
+        return mWeights;
+    }
+
+    void setWeights(const Features &weights);
+
+    /**
+     * @brief featureName
+     * @param feature
+     * @return name of the feature, as written in the weights file
+     */
+    static QString featureName(int feature);
+
+private:
+    Features mWeights;
+
+    /**
+     * @brief mNetwork the evaluation network (shared by the copies)
+     */
+    std::shared_ptr<const Network> mNetwork;
+
+    /**
+     * @brief mUseThreats wether the threatened units have a weight
+     * (they are not counted otherwise : it needs to go through all the units)
+     */
+    bool mUseThreats = false;
+};
+
+#endif // EVALUATION_HPP
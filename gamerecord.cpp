@@ -0,0 +1,394 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   gamerecord.cpp
+ * Author: azarias
+ *
+ * Created on 2/3/2018
+ */
+#include "gamerecord.hpp"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <cstring>
+
+namespace {
+
+void appendVarint(QByteArray &bytes, quint64 value)
+{
+    while(value >= 0x80){
+        bytes.append(char((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    bytes.append(char(value));
+}
+
+bool readVarint(const QByteArray &bytes, int &position, quint64 &value)
+{
+    value = 0;
+    for(int shift = 0; shift < 64 && position < bytes.size(); shift += 7){
+        quint8 byte = quint8(bytes[position++]);
+        value |= quint64(byte & 0x7F) << shift;
+        if(!(byte & 0x80))return true;
+    }
+    return false;
+}
+
+template<typename T>
+void appendRaw(QByteArray &bytes, T value)
+{
+    bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+bool readRaw(const QByteArray &bytes, int &position, T &value)
+{
+    if(position + (int)sizeof(T) > bytes.size())return false;
+    std::memcpy(&value, bytes.constData() + position, sizeof(T));
+    position += sizeof(T);
+    return true;
+}
+
+/**
+ * @brief isInteger
+ * @param value
+ * @return wether the json value is an integer (an int in the message)
+ */
+bool isInteger(const QJsonValue &value)
+{
+    return value.isDouble() && value.toDouble() == value.toInt();
+}
+
+/**
+ * @brief readCoordinates reads a coordinates json object
+ * @param value
+ * @param coords
+ * @return wether it only contains valid coordinates
+ */
+bool readCoordinates(const QJsonValue &value, Coordinates &coords)
+{
+    const QJsonObject obj = value.toObject();
+    if(!value.isObject() || obj.size() != 2 || !isInteger(obj["x"]) || !isInteger(obj["y"]))return false;
+    coords = Coordinates(obj);
+    return coords.isValid();
+}
+
+/**
+ * @brief encodeBoard packs the units of a get_board message
+ * @param units
+ * @param payload
+ * @return wether the units could be packed
+ */
+bool encodeBoard(const QJsonArray &units, QByteArray &payload)
+{
+    appendVarint(payload, units.size());
+    for(const QJsonValue &value : units){
+        const QJsonObject unit = value.toObject();
+        const QJsonObject pawn = unit["pawn"].toObject();
+        Coordinates coords;
+        if(unit.size() != 2 || !readCoordinates(unit["coordinates"], coords) || pawn.size() != 2)return false;
+        if(!isInteger(pawn["type"]) || !isInteger(pawn["color"]))return false;
+
+        int type = pawn["type"].toInt();
+        int color = pawn["color"].toInt();
+        if(type < Unit::MOBILE_TOWER || type > Unit::GUNNER || (color != Unit::WHITE && color != Unit::BLACK))return false;
+
+        appendRaw<quint16>(payload, coords.index());
+        appendRaw<quint8>(payload, type | color << 2);
+    }
+    return true;
+}
+
+bool decodeBoard(const QByteArray &payload, int &position, QJsonArray &units)
+{
+    quint64 count;
+    if(!readVarint(payload, position, count))return false;
+    for(quint64 i = 0; i < count; ++i){
+        quint16 index;
+        quint8 pawnBits;
+        if(!readRaw(payload, position, index) || !readRaw(payload, position, pawnBits) || index >= Geometry::SIZE)return false;
+
+        QJsonObject pawn;
+        pawn["type"] = pawnBits & 3;
+        pawn["color"] = pawnBits >> 2;
+
+        QJsonObject unit;
+        unit["coordinates"] = Coordinates::fromIndex(index).toJsonObjet();
+        unit["pawn"] = pawn;
+        units.append(unit);
+    }
+    return true;
+}
+
+/**
+ * @brief simpleKinds the messages without data
+ */
+const std::pair<const char*, GameRecord::KIND> simpleKinds[] = {
+    {"your_turn", GameRecord::YOUR_TURN},
+    {"end_turn", GameRecord::END_TURN},
+    {"get_board", GameRecord::GET_BOARD},
+    {"is_ready", GameRecord::READY},
+    {"you_win", GameRecord::WIN},
+    {"you_loose", GameRecord::LOOSE}
+};
+
+/**
+ * @brief packMessage packs the known messages
+ * @param message
+ * @param kind
+ * @param payload
+ * @return wether the message is a known message
+ */
+bool packMessage(const QJsonObject &message, GameRecord::KIND &kind, QByteArray &payload)
+{
+    QString type = message["type"].toString();
+    bool hasId = message.contains("id");
+    bool hasData = message.contains("data");
+    if(int(message.size()) != 1 + hasId + hasData)return false;//unknown fields
+    if(hasId && (!isInteger(message["id"]) || message["id"].toInt() < 0))return false;
+
+    appendVarint(payload, hasId ? message["id"].toInt() + 1 : 0);
+
+    if(!hasData){
+        for(const auto &simple : simpleKinds){
+            if(type == simple.first){
+                kind = simple.second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    QJsonValue data = message["data"];
+    if(type == "get_board" && data.isArray()){
+        kind = GameRecord::BOARD;
+        return encodeBoard(data.toArray(), payload);
+    }else if(type == "your_id" && isInteger(data) && (data.toInt() == 0 || data.toInt() == 1)){
+        kind = GameRecord::ID;
+        appendRaw<quint8>(payload, data.toInt());
+        return true;
+    }else if((type == "move" || type == "attack") && data.isObject()){
+        const QJsonObject obj = data.toObject();
+        Coordinates from, to;
+        if(obj.size() != 2 || !readCoordinates(obj["from"], from) || !readCoordinates(obj["to"], to))return false;
+        kind = type == "move" ? GameRecord::MOVE : GameRecord::ATTACK;
+        appendRaw<quint16>(payload, from.index());
+        appendRaw<quint16>(payload, to.index());
+        return true;
+    }
+    return false;
+}
+
+}
+
+QByteArray GameRecord::encode(const QJsonObject &message, KIND &kind)
+{
+    QByteArray payload;
+    if(packMessage(message, kind, payload))return payload;
+
+    kind = TEXT;
+    return QJsonDocument(message).toJson(QJsonDocument::Compact);
+}
+
+bool GameRecord::decode(KIND kind, const QByteArray &payload, QJsonObject &message)
+{
+    message = QJsonObject();
+    if(kind == TEXT){
+        QJsonDocument doc = QJsonDocument::fromJson(payload);
+        message = doc.object();
+        return doc.isObject();
+    }
+
+    int position = 0;
+    quint64 id;
+    if(!readVarint(payload, position, id))return false;
+    if(id)message["id"] = qint64(id - 1);
+
+    for(const auto &simple : simpleKinds){
+        if(kind == simple.second){
+            message["type"] = simple.first;
+            return position == payload.size();
+        }
+    }
+
+    switch(kind){
+    case BOARD:{
+        QJsonArray units;
+        if(!decodeBoard(payload, position, units))return false;
+        message["type"] = "get_board";
+        message["data"] = units;
+        break;
+    }
+    case ID:{
+        quint8 playerId;
+        if(!readRaw(payload, position, playerId))return false;
+        message["type"] = "your_id";
+        message["data"] = playerId;
+        break;
+    }
+    case MOVE:
+    case ATTACK:{
+        quint16 from, to;
+        if(!readRaw(payload, position, from) || !readRaw(payload, position, to))return false;
+        if(from >= Geometry::SIZE || to >= Geometry::SIZE)return false;
+        QJsonObject data;
+        data["from"] = Coordinates::fromIndex(from).toJsonObjet();
+        data["to"] = Coordinates::fromIndex(to).toJsonObjet();
+        message["type"] = kind == MOVE ? "move" : "attack";
+        message["data"] = data;
+        break;
+    }
+    default:
+        return false;
+    }
+    return position == payload.size();
+}
+
+GameRecorder::GameRecorder()
+{
+
+}
+
+bool GameRecorder::open(const QString &path)
+{
+    mFile.close();
+    mFile.setFileName(path);
+    if(!mFile.open(QIODevice::WriteOnly | QIODevice::Append))return false;
+
+    if(mFile.size() == 0){
+        GameRecord::Header header = {GameRecord::mMagic, GameRecord::mVersion, Geometry::WIDTH, Geometry::HEIGHT};
+        mFile.write(reinterpret_cast<const char*>(&header), sizeof(GameRecord::Header));
+        mFile.flush();
+    }
+    mTimer.start();
+    return true;
+}
+
+void GameRecorder::recordMessage(const QJsonObject &message, bool sent)
+{
+    if(!isOpen())return;
+
+    GameRecord::KIND kind;
+    QByteArray payload = GameRecord::encode(message, kind);
+    write(kind | (sent ? GameRecord::SENT : 0), payload);
+}
+
+void GameRecorder::recordDecision(const BattleField &field, const Turn &turn, const Engine::Decision &decision)
+{
+    if(!isOpen())return;
+
+    QByteArray payload;
+    appendRaw<quint64>(payload, field.hash());
+    appendRaw<quint32>(payload, turn.pack());
+    appendRaw<float>(payload, decision.score);
+    appendRaw<quint8>(payload, decision.source);
+    appendRaw<quint8>(payload, decision.depth);
+    appendVarint(payload, decision.time);
+    write(GameRecord::DECISION, payload);
+}
+
+void GameRecorder::recordConnection()
+{
+    if(isOpen())write(GameRecord::CONNECTED, QByteArray());
+}
+
+void GameRecorder::write(quint8 kind, const QByteArray &payload)
+{
+    QByteArray entry;
+    entry.append(char(kind));
+    appendVarint(entry, mTimer.restart());
+    appendVarint(entry, payload.size());
+    entry.append(payload);
+
+    mFile.write(entry);
+    mFile.flush();
+}
+
+GameRecordReader::GameRecordReader()
+{
+
+}
+
+bool GameRecordReader::open(const QString &path)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))return false;
+    mData = file.readAll();
+    mPosition = 0;
+    mTime = 0;
+    mSync.connected();
+
+    GameRecord::Header header;
+    if(!readRaw(mData, mPosition, header))return false;
+    return header.magic == GameRecord::mMagic && header.version >= 1 && header.version <= GameRecord::mVersion &&
+            header.width == Geometry::WIDTH && header.height == Geometry::HEIGHT;
+}
+
+bool GameRecordReader::next(GameRecord::Entry &entry)
+{
+    quint8 kind;
+    quint64 delay, size;
+    if(!readRaw(mData, mPosition, kind) || !readVarint(mData, mPosition, delay) ||
+            !readVarint(mData, mPosition, size) || size > quint64(mData.size() - mPosition))return false;
+
+    QByteArray payload = mData.mid(mPosition, size);
+    mPosition += size;
+
+    mTime += delay;
+    entry = GameRecord::Entry();
+    entry.time = mTime;
+    entry.sent = kind & GameRecord::SENT;
+    entry.kind = static_cast<GameRecord::KIND>(kind & ~GameRecord::SENT);
+
+    if(entry.kind != GameRecord::DECISION){
+        if(entry.kind != GameRecord::CONNECTED && !GameRecord::decode(entry.kind, payload, entry.message))return false;
+        follow(entry);
+        return true;
+    }
+
+    int position = 0;
+    quint8 source, depth;
+    quint64 time;
+    if(!readRaw(payload, position, entry.hash) || !readRaw(payload, position, entry.turn) ||
+            !readRaw(payload, position, entry.decision.score) || !readRaw(payload, position, source) ||
+            !readRaw(payload, position, depth) || !readVarint(payload, position, time))return false;
+    entry.decision.source = static_cast<Engine::SOURCE>(source);
+    entry.decision.depth = depth;
+    entry.decision.time = time;
+    return true;
+}
+
+void GameRecordReader::follow(const GameRecord::Entry &entry)
+{
+    if(entry.kind == GameRecord::CONNECTED){
+        mSync.connected();
+    }else if(entry.sent){
+        if(entry.message["type"].toString() == "get_board")mSync.boardRequested();
+    }else{
+        //the get_board sent by the client is already recorded after the message
+        bool resync;
+        mSync.received(entry.message, resync);
+    }
+}
@@ -0,0 +1,271 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   gamerecord.hpp
+ * Author: azarias
+ *
+ * Created on 2/3/2018
+ */
+#ifndef GAMERECORD_HPP
+#define GAMERECORD_HPP
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonObject>
+#include <QString>
+
+#include "boardsync.hpp"
+#include "engine.hpp"
+
+/**
+ * @brief The GameRecord struct
+ * format of the game records : an append-only binary log
+ * of all the messages exchanged with the server, and of the
+ * decisions of the engine.
+ *
+ * The file starts with a header, then each entry is :
+ * - one byte : the kind of entry (+ 0x80 for a message sent by the client)
+ * - a varint : the milliseconds since the previous entry
+ * - a varint : the size of the payload
+ * - the payload
+ * A connection to the server is an entry without payload.
+ * The usual messages are packed (fields as 16 bits indexes,
+ * units as 3 bytes), the others are kept as json text
+ */
+struct GameRecord{
+    /**
+     * @brief The KIND enum the kind of an entry
+     */
+    enum KIND : quint8 {
+        TEXT,//any message, as json text
+        BOARD,//get_board with the units
+        ID,//your_id
+        YOUR_TURN,
+        MOVE,
+        ATTACK,
+        END_TURN,
+        GET_BOARD,//get_board request, without units
+        READY,//is_ready
+        WIN,//you_win
+        LOOSE,//you_loose
+        DECISION,//turn chosen by the engine
+        CONNECTED//connection to the server (version 2)
+    };
+
+    /**
+     * @brief SENT flag of the messages sent by the client
+     */
+    static const quint8 SENT = 0x80;
+
+    /**
+     * @brief The Entry struct an entry of the record
+     */
+    struct Entry{
+        KIND kind = TEXT;
+
+        /**
+         * @brief sent wether the message was sent by the client
+         */
+        bool sent = false;
+
+        /**
+         * @brief time milliseconds since the start of the record
+         */
+        qint64 time = 0;
+
+        /**
+         * @brief message the message (not for a decision)
+         */
+        QJsonObject message;
+
+        /**
+         * @brief hash zobrist hash of the position (decision only)
+         */
+        quint64 hash = 0;
+
+        /**
+         * @brief turn packed turn played (decision only)
+         */
+        quint32 turn = 0;
+
+        /**
+         * @brief decision how the turn was chosen (decision only)
+         */
+        Engine::Decision decision;
+    };
+
+    /**
+     * @brief encode packs the given message
+     * @param message
+     * @param kind set to the kind of entry
+     * @return the payload
+     */
+    static QByteArray encode(const QJsonObject &message, KIND &kind);
+
+    /**
+     * @brief decode unpacks a message
+     * @param kind
+     * @param payload
+     * @param message set to the message
+     * @return wether the payload is valid
+     */
+    static bool decode(KIND kind, const QByteArray &payload, QJsonObject &message);
+
+    static const quint32 mMagic = 0x43455247;// "GREC"
+
+    static const quint16 mVersion = 2;
+
+    /**
+     * @brief The Header struct header of the record file
+     */
+    struct Header{
+        quint32 magic;
+        quint16 version;
+        quint8 width;
+        quint8 height;
+    };
+};
+
+/**
+ * @brief The GameRecorder class
+ * writes the game record of the client, each entry
+ * is written as soon as it is recorded so that nothing
+ * is lost if the client stops
+ */
+class GameRecorder
+{
+public:
+    GameRecorder();
+
+    /**
+     * @brief open opens the given record, the entries
+     * are appended if it already exists
+     * @param path
+     * @return wether the file could be opened
+     */
+    bool open(const QString &path);
+
+    /**
+     * @brief isOpen
+     * @return wether a record is opened
+     */
+    bool isOpen() const
+    {
+        return mFile.isOpen();
+    }
+
+    /**
+     * @brief recordMessage records a message
+     * @param message
+     * @param sent wether it is sent by the client
+     */
+    void recordMessage(const QJsonObject &message, bool sent);
+
+    /**
+     * @brief recordDecision records the turn chosen by the engine
+     * @param field the position
+     * @param turn
+     * @param decision
+     */
+    void recordDecision(const BattleField &field, const Turn &turn, const Engine::Decision &decision);
+
+    /**
+     * @brief recordConnection records a connection to the server
+     * (the ids of the messages may start again)
+     */
+    void recordConnection();
+
+private:
+    /**
+     * @brief write writes an entry
+     * @param kind with the sent flag
+     * @param payload
+     */
+    void write(quint8 kind, const QByteArray &payload);
+
+    QFile mFile;
+
+    /**
+     * @brief mTimer time since the previous entry
+     */
+    QElapsedTimer mTimer;
+};
+
+/**
+ * @brief The GameRecordReader class
+ * reads a game record, entry by entry, and follows the
+ * battlefield of the client with the same rules it used
+ */
+class GameRecordReader
+{
+public:
+    GameRecordReader();
+
+    /**
+     * @brief open opens the given record
+     * @param path
+     * @return wether the file is a valid record
+     * (for a battlefield of the same size, the records of
+     * version 1 have no connection)
+     */
+    bool open(const QString &path);
+
+    /**
+     * @brief next reads the next entry, the battlefield
+     * is updated with the messages (see getField)
+     * @param entry
+     * @return false at the end of the record (or when the
+     * end of the record is corrupted)
+     */
+    bool next(GameRecord::Entry &entry);
+
+    /**
+     * @brief getField
+     * @return the battlefield of the client after the last entry read
+     * (the position of a decision, when the entry is one)
+     */
+    const BattleField &getField() const
+    {
+        return mSync.getField();
+    }
+
+private:
+    /**
+     * @brief follow applies the given entry to the battlefield
+     * @param entry
+     */
+    void follow(const GameRecord::Entry &entry);
+
+    BoardSync mSync;
+
+    QByteArray mData;
+
+    int mPosition = 0;
+
+    qint64 mTime = 0;
+};
+
+#endif // GAMERECORD_HPP
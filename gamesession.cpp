@@ -0,0 +1,200 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   gamesession.cpp
+ * Author: azarias
+ *
+ * Created on 3/3/2018
+ */
+#include "gamesession.hpp"
+#include "trace.hpp"
+
+#include <QDebug>
+#include <QJsonDocument>
+
+GameSession::GameSession(Listener &listener):
+    mListener(listener)
+{
+
+}
+
+GameSession::~GameSession()
+{
+    if(mMetrics)mMetrics->remove(mMetricsName);
+}
+
+void GameSession::setMetrics(MetricsRegistry *metrics, const QString &name)
+{
+    if(mMetrics)mMetrics->remove(mMetricsName);
+    mMetrics = metrics;
+    mMetricsName = name;
+    publish();
+}
+
+void GameSession::publish()
+{
+    if(mMetrics)mMetrics->update(mMetricsName, mPublished);
+}
+
+void GameSession::start()
+{
+    mRecorder.recordConnection();
+    mSync.connected();
+    requestResync();
+}
+
+void GameSession::requestResync()
+{
+    mSync.boardRequested();
+    QJsonObject message;
+    message["type"] = "get_board";
+    send(message);
+}
+
+void GameSession::send(const QJsonObject &message)
+{
+    mRecorder.recordMessage(message, true);
+    mListener.send(message);
+}
+
+void GameSession::messageReceived(const QString &msg)
+{
+    GUERRILLA_TRACE("messageReceived");
+    QElapsedTimer received;
+    received.start();
+
+    QJsonDocument doc;
+    {
+        GUERRILLA_TRACE("parse message");
+        doc = QJsonDocument::fromJson(msg.toUtf8());
+    }
+    if(doc.isNull()){
+        qDebug() << "Error while parsing json";
+        return;
+    }
+    mRecorder.recordMessage(doc.object(), false);
+
+    bool resync;
+    const BoardSync::EVENT event = mSync.received(doc.object(), resync);
+    if(resync)requestResync();
+
+    //the game started : the server got the is_ready
+    const QString type = doc.object()["type"].toString();
+    if(type == "your_turn" || type == "move" || type == "attack")mReadyAcknowledged = true;
+
+    switch(event){
+    case BoardSync::ID:
+        mId = mSync.getField().getId();
+        mListener.boardChanged();//the player's units changed
+        break;
+    case BoardSync::BOARD:
+        boardReceived();
+        if(mTurnPending){
+            mTurnPending = false;
+            play();
+        }
+        break;
+    case BoardSync::TURN:
+        mTurnReceived = received;
+        if(mSync.isSyncing()){
+            mTurnPending = true;//play once the board is up to date
+        }else{
+            play();
+        }
+        break;
+    case BoardSync::MOVED:
+        mListener.squareChanged(mSync.getFrom());
+        mListener.squareChanged(mSync.getTo());
+        break;
+    case BoardSync::ATTACKED:
+        mListener.squareChanged(mSync.getTo());
+        break;
+    case BoardSync::WON:
+    case BoardSync::LOST:
+        mPublished.playing = false;
+        publish();
+        mListener.gameOver(event == BoardSync::WON);
+        break;
+    default:
+        break;
+    }
+}
+
+void GameSession::play()
+{
+    if(!mTurnReceived.isValid())mTurnReceived.start();
+    const qint64 queued = mTurnReceived.nsecsElapsed() / 1000;
+
+    if(mMetrics)mMetrics->setSearching(mMetricsName, true);
+    Turn turn = mEngine.play(mSync.getField());
+    const qint64 searched = mTurnReceived.nsecsElapsed() / 1000;
+    mRecorder.recordDecision(mSync.getField(), turn, mEngine.lastDecision());
+    mListener.turnChosen(turn, mEngine.lastDecision());
+
+    for(quint8 i = 0; i < 2; ++i){
+        if(turn.getAction(i))send(turn.getAction(i)->toJson());
+    }
+
+    QJsonObject endTurn;
+    endTurn["type"] = "end_turn";
+    send(endTurn);
+
+    const qint64 sent = mTurnReceived.nsecsElapsed() / 1000;
+    mLatencies.queue.record(queued);
+    mLatencies.search.record(searched - queued);
+    mLatencies.send.record(sent - searched);
+    mLatencies.total.record(sent);
+    mTurnReceived.invalidate();
+
+    if(mMetrics){
+        const Engine::Decision &decision = mEngine.lastDecision();
+        const TranspositionTable &table = mEngine.getCache().table;
+        ++mPublished.turns;
+        mPublished.nodes += decision.nodes;
+        mPublished.searchTime += decision.time;
+        if(decision.source == Engine::SEARCH && decision.time)mPublished.nodesPerSecond = decision.nodes * 1e6 / decision.time;
+        mPublished.tableUsage = table.usage();
+        mPublished.memory = mSync.getField().memoryUsage() + table.memoryUsage() + decision.memory;
+        mPublished.latencies = mLatencies;
+        publish();
+    }
+}
+
+void GameSession::boardReceived()
+{
+    mListener.boardChanged();
+
+    if(mReadyAcknowledged)return;//resync : the server is not waiting for is_ready
+
+    //sent again until the game starts : it may have been lost in a disconnection
+    if(!mBoardReceived){
+        mBoardReceived = true;
+        mPublished.playing = true;
+        publish();
+    }
+    QJsonObject ready;
+    ready["type"] = "is_ready";
+    send(ready);
+}
@@ -0,0 +1,283 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   gamesession.hpp
+ * Author: azarias
+ *
+ * Created on 3/3/2018
+ */
+#ifndef GAMESESSION_HPP
+#define GAMESESSION_HPP
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QElapsedTimer>
+
+#include "battlefield.hpp"
+#include "boardsync.hpp"
+#include "engine.hpp"
+#include "gamerecord.hpp"
+#include "latency.hpp"
+#include "metrics.hpp"
+
+/**
+ * @brief The GameSession class
+ * the client side of the protocol : keeps the battlefield
+ * up to date with the messages of the server (see BoardSync), and plays
+ * (with its engine) when the server asks to.
+ * It does not know how the messages are transported,
+ * nor how the game is displayed : this is done by its listener
+ */
+class GameSession
+{
+public:
+    /**
+     * @brief The Listener class
+     * what is notified by the session
+     */
+    class Listener
+    {
+    public:
+        virtual ~Listener(){}
+
+        /**
+         * @brief send must send the given message to the server
+         * @param message
+         */
+        virtual void send(const QJsonObject &message) = 0;
+
+        /**
+         * @brief boardChanged the whole board changed
+         * (a board was received, or the player's id)
+         */
+        virtual void boardChanged(){}
+
+        /**
+         * @brief squareChanged the unit at the given coordinates changed
+         * @param coords
+         */
+        virtual void squareChanged(const Coordinates &coords){ Q_UNUSED(coords); }
+
+        /**
+         * @brief turnChosen the engine chose the turn to play
+         * (just before it is sent)
+         * @param turn
+         * @param decision
+         */
+        virtual void turnChosen(const Turn &turn, const Engine::Decision &decision){ Q_UNUSED(turn); Q_UNUSED(decision); }
+
+        /**
+         * @brief gameOver the game is finished
+         * @param won wether the player won
+         */
+        virtual void gameOver(bool won){ Q_UNUSED(won); }
+    };
+
+    /**
+     * @brief GameSession constructor
+     * @param listener must outlive the session
+     */
+    explicit GameSession(Listener &listener);
+
+    /**
+     * @brief ~GameSession removes the session from its metrics
+     */
+    ~GameSession();
+
+    /**
+     * @brief setMetrics publishes the metrics of the session
+     * (after each turn, and when a search starts)
+     * @param metrics must outlive the session
+     * @param name name of the session in the metrics
+     */
+    void setMetrics(MetricsRegistry *metrics, const QString &name);
+
+    /**
+     * @brief start to call once connected to the server
+     * (or reconnected) : asks for the board
+     */
+    void start();
+
+    /**
+     * @brief messageReceived handles a message of the server
+     * @param msg
+     */
+    void messageReceived(const QString &msg);
+
+    /**
+     * @brief getBattleField getter for the battlefield
+     * @return
+     */
+    const BattleField &getBattleField() const
+    {
+        return mSync.getField();
+    }
+
+    /**
+     * @brief getEngine getter for the engine
+     * (to load its book and tablebases)
+     * @return
+     */
+    Engine &getEngine()
+    {
+        return mEngine;
+    }
+
+    /**
+     * @brief getRecorder getter for the recorder
+     * (nothing is recorded until it is opened)
+     * @return
+     */
+    GameRecorder &getRecorder()
+    {
+        return mRecorder;
+    }
+
+    /**
+     * @brief getLatencies how long the turns took
+     * @return
+     */
+    const TurnLatencies &getLatencies() const
+    {
+        return mLatencies;
+    }
+
+    /**
+     * @brief getId id of the player
+     * @return
+     */
+    int getId() const
+    {
+        return mId;
+    }
+
+private:
+    /**
+     * @brief requestResync asks the server for the whole
+     * board, the moves and attacks received until the board
+     * arrives are ignored since they are already included in it
+     * (see BoardSync)
+     */
+    void requestResync();
+
+    /**
+     * @brief send sends the given message to the server
+     * (and records it)
+     * @param message
+     */
+    void send(const QJsonObject &message);
+
+    /**
+     * @brief boardReceived a board was received (the battlefield is already
+     * filled), sends is_ready while the game has not started
+     */
+    void boardReceived();
+
+    /**
+     * @brief play
+     * when it's the player's turn to make a move
+     * will calculate the best move and send it to the
+     * server
+     */
+    void play();
+
+    /**
+     * @brief mListener
+     */
+    Listener &mListener;
+
+    /**
+     * @brief mSync the battlefield, kept in line with the messages
+     */
+    BoardSync mSync;
+
+    /**
+     * @brief mEngine the bot, kept for the whole game
+     * (opening book, tablebases and search cache)
+     */
+    Engine mEngine;
+
+    /**
+     * @brief mRecorder record of all the messages and
+     * decisions of the engine
+     */
+    GameRecorder mRecorder;
+
+    /**
+     * @brief mLatencies how long the turns took
+     */
+    TurnLatencies mLatencies;
+
+    /**
+     * @brief mMetrics the registry where the metrics are published (may be null)
+     */
+    MetricsRegistry *mMetrics = nullptr;
+
+    /**
+     * @brief mMetricsName name of the session in the registry
+     */
+    QString mMetricsName;
+
+    /**
+     * @brief mPublished the metrics of the session
+     */
+    SessionMetrics mPublished;
+
+    /**
+     * @brief publish publishes the metrics, if there is a registry
+     */
+    void publish();
+
+    /**
+     * @brief mTurnReceived started when the your_turn message arrived
+     */
+    QElapsedTimer mTurnReceived;
+
+    /**
+     * @brief mId id of the player
+     */
+    int mId = -1;
+
+    /**
+     * @brief mTurnPending wether the server asked to play
+     * while the board was resynchronizing, the turn
+     * is played as soon as the board arrives
+     */
+    bool mTurnPending = false;
+
+    /**
+     * @brief mBoardReceived wether a board was already received
+     */
+    bool mBoardReceived = false;
+
+    /**
+     * @brief mReadyAcknowledged wether the game started, the server
+     * only waits for is_ready until then
+     */
+    bool mReadyAcknowledged = false;
+};
+
+#endif // GAMESESSION_HPP
@@ -0,0 +1,79 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   geometry.hpp
+ * Author: azarias
+ *
+ * Created on 28/2/2018
+ */
+#ifndef GEOMETRY_HPP
+#define GEOMETRY_HPP
+
+/**
+ * The size of the battlefield is fixed at compile time,
+ * the default is the 25x25 board of the server.
+ * Smaller boards (the practice board, see geometry.pri)
+ * are built by defining GUERRILLA_BOARD_WIDTH and GUERRILLA_BOARD_HEIGHT
+ */
+#ifndef GUERRILLA_BOARD_WIDTH
+#define GUERRILLA_BOARD_WIDTH 25
+#endif
+
+#ifndef GUERRILLA_BOARD_HEIGHT
+#define GUERRILLA_BOARD_HEIGHT 25
+#endif
+
+/**
+ * @brief The Geometry struct
+ * dimensions of the battlefield, known at compile time
+ * so that all the index math is folded by the compiler
+ */
+struct Geometry{
+    /**
+     * @brief WIDTH number of columns
+     */
+    static constexpr int WIDTH = GUERRILLA_BOARD_WIDTH;
+
+    /**
+     * @brief HEIGHT number of lines
+     */
+    static constexpr int HEIGHT = GUERRILLA_BOARD_HEIGHT;
+
+    /**
+     * @brief SIZE number of fields
+     */
+    static constexpr int SIZE = WIDTH * HEIGHT;
+
+    /**
+     * @brief HALF_WIDTH number of columns of the left half
+     * (middle column included)
+     */
+    static constexpr int HALF_WIDTH = (WIDTH + 1) / 2;
+};
+
+// a field index is packed on 10 bits in the turns
+static_assert(Geometry::WIDTH > 0 && Geometry::HEIGHT > 0 && Geometry::SIZE <= 1024, "The battlefield must have between 1 and 1024 fields");
+
+#endif // GEOMETRY_HPP
@@ -0,0 +1,13 @@
+#-------------------------------------------------
+#
+# Size of the battlefield, shared by all the projects
+# (the tables and files they exchange depend on it)
+#
+# qmake CONFIG+=practice builds everything for the
+# smaller practice board
+#
+#-------------------------------------------------
+
+practice {
+    DEFINES += GUERRILLA_BOARD_WIDTH=13 GUERRILLA_BOARD_HEIGHT=13
+}
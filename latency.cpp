@@ -0,0 +1,122 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   latency.cpp
+ * Author: azarias
+ *
+ * Created on 11/3/2018
+ */
+#include "latency.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/**
+ * @brief MAX_BITS the longest duration counted (in bits of microseconds),
+ * the longer ones are in the last bucket
+ */
+const int MAX_BITS = 40;
+
+}
+
+LatencyHistogram::LatencyHistogram():
+    mBuckets(bucketOf((quint64(1) << MAX_BITS) - 1) + 1, 0)
+{
+
+}
+
+int LatencyHistogram::bucketOf(quint64 value)
+{
+    //the first 2 * SUB_COUNT values have their own bucket, then
+    //each power of two is split in SUB_COUNT buckets
+    if(value < 2 * SUB_COUNT)return int(value);
+
+    int highest = SUB_BITS + 1;
+    while(value >> (highest + 1))++highest;
+    const int shift = highest - SUB_BITS;
+    return shift * SUB_COUNT + int(value >> shift);
+}
+
+quint64 LatencyHistogram::highestOf(int bucket)
+{
+    if(bucket < 2 * SUB_COUNT)return quint64(bucket);
+
+    const int shift = bucket / SUB_COUNT - 1;
+    const quint64 mantissa = bucket % SUB_COUNT + SUB_COUNT;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(qint64 micros)
+{
+    const quint64 value = quint64(std::max<qint64>(micros, 0));
+    const int bucket = std::min(bucketOf(value), int(mBuckets.size()) - 1);
+    ++mBuckets[bucket];
+    ++mCount;
+    mSum += qint64(value);
+    mMax = std::max(mMax, qint64(value));
+}
+
+qint64 LatencyHistogram::percentile(double percent) const
+{
+    if(!mCount)return 0;
+
+    const quint64 rank = std::max<quint64>(1, quint64(std::ceil(mCount * percent / 100.)));
+    quint64 seen = 0;
+    for(std::size_t bucket = 0; bucket < mBuckets.size(); ++bucket){
+        seen += mBuckets[bucket];
+        if(seen >= rank)return std::min(qint64(highestOf(int(bucket))), mMax);
+    }
+    return mMax;
+}
+
+void LatencyHistogram::reset()
+{
+    std::fill(mBuckets.begin(), mBuckets.end(), 0);
+    mCount = 0;
+    mSum = 0;
+    mMax = 0;
+}
+
+QJsonObject LatencyHistogram::toJson() const
+{
+    QJsonObject obj;
+    obj["count"] = qint64(mCount);
+    obj["p50"] = percentile(50.);
+    obj["p99"] = percentile(99.);
+    obj["max"] = mMax;
+    return obj;
+}
+
+QJsonObject TurnLatencies::toJson() const
+{
+    QJsonObject obj;
+    obj["queue"] = queue.toJson();
+    obj["search"] = search.toJson();
+    obj["send"] = send.toJson();
+    obj["total"] = total.toJson();
+    return obj;
+}
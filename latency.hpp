@@ -0,0 +1,168 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   latency.hpp
+ * Author: azarias
+ *
+ * Created on 11/3/2018
+ */
+#ifndef LATENCY_HPP
+#define LATENCY_HPP
+
+#include <QJsonObject>
+#include <QtGlobal>
+
+#include <vector>
+
+/**
+ * @brief The LatencyHistogram class
+ * counts durations (in microseconds) in buckets of the same relative
+ * width (about 3%, like HDR histograms) : recording is a few shifts,
+ * whatever the number of values, and the percentiles are
+ * precise enough from a microsecond to days
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    /**
+     * @brief record counts the given duration
+     * @param micros duration in microseconds (negative ones are counted as 0)
+     */
+    void record(qint64 micros);
+
+    /**
+     * @brief percentile
+     * @param percent between 0 and 100
+     * @return the duration under which the given part of the values are
+     * (upper bound of its bucket), 0 without values
+     */
+    qint64 percentile(double percent) const;
+
+    /**
+     * @brief getCount number of durations recorded
+     * @return
+     */
+    quint64 getCount() const
+    {
+        return mCount;
+    }
+
+    /**
+     * @brief getSum total of the durations recorded
+     * @return
+     */
+    qint64 getSum() const
+    {
+        return mSum;
+    }
+
+    /**
+     * @brief getMax longest duration recorded (exact)
+     * @return
+     */
+    qint64 getMax() const
+    {
+        return mMax;
+    }
+
+    /**
+     * @brief reset forgets all the durations
+     */
+    void reset();
+
+    /**
+     * @brief toJson
+     * @return the count, p50, p99 and max, in microseconds
+     */
+    QJsonObject toJson() const;
+
+private:
+    /**
+     * @brief SUB_BITS each power of two is split in 2^SUB_BITS buckets
+     */
+    static const int SUB_BITS = 5;
+
+    static const int SUB_COUNT = 1 << SUB_BITS;
+
+    /**
+     * @brief bucketOf
+     * @param value
+     * @return the bucket counting the given value
+     */
+    static int bucketOf(quint64 value);
+
+    /**
+     * @brief highestOf
+     * @param bucket
+     * @return the highest value counted in the given bucket
+     */
+    static quint64 highestOf(int bucket);
+
+    std::vector<quint64> mBuckets;
+
+    quint64 mCount = 0;
+
+    qint64 mSum = 0;
+
+    qint64 mMax = 0;
+};
+
+/**
+ * @brief The TurnLatencies struct
+ * how long the turns take, from the your_turn message
+ * to the end_turn message sent
+ */
+struct TurnLatencies{
+    /**
+     * @brief queue from the your_turn message to the start of the search
+     * (parsing, and waiting for the board when it is resynchronized)
+     */
+    LatencyHistogram queue;
+
+    /**
+     * @brief search time taken by the engine
+     */
+    LatencyHistogram search;
+
+    /**
+     * @brief send recording, serialization and sending of the actions and end_turn
+     */
+    LatencyHistogram send;
+
+    /**
+     * @brief total from the your_turn message to end_turn
+     */
+    LatencyHistogram total;
+
+    /**
+     * @brief toJson
+     * @return the four histograms
+     */
+    QJsonObject toJson() const;
+};
+
+#endif // LATENCY_HPP
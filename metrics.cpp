@@ -0,0 +1,150 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   metrics.cpp
+ * Author: azarias
+ *
+ * Created on 12/3/2018
+ */
+#include "metrics.hpp"
+
+namespace {
+
+/**
+ * @brief label a session label, quotes and backslashes escaped
+ * @param session
+ * @return
+ */
+QByteArray label(const QString &session)
+{
+    QByteArray escaped;
+    for(char c : session.toUtf8()){
+        if(c == '"' || c == '\\')escaped.append('\\');
+        if(c == '\n'){
+            escaped.append("\\n", 2);
+            continue;
+        }
+        escaped.append(c);
+    }
+    return "session=\"" + escaped + "\"";
+}
+
+/**
+ * @brief header the help and type lines of a metric
+ * @param out
+ * @param name
+ * @param type
+ * @param help
+ */
+void header(QByteArray &out, const char *name, const char *type, const char *help)
+{
+    out.append(QByteArray("# HELP ") + name + " " + help + "\n");
+    out.append(QByteArray("# TYPE ") + name + " " + type + "\n");
+}
+
+void sample(QByteArray &out, const QByteArray &name, const QByteArray &labels, double value)
+{
+    out.append(name + "{" + labels + "} " + QByteArray::number(value, 'g', 12) + "\n");
+}
+
+}
+
+void MetricsRegistry::update(const QString &session, const SessionMetrics &metrics)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSessions[session] = metrics;
+}
+
+void MetricsRegistry::setSearching(const QString &session, bool searching)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSessions[session].searching = searching;
+}
+
+void MetricsRegistry::remove(const QString &session)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSessions.erase(session);
+}
+
+QByteArray MetricsRegistry::exposition() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    QByteArray out;
+
+    int playing = 0, searching = 0;
+    for(const auto &session : mSessions){
+        playing += session.second.playing;
+        searching += session.second.searching;
+    }
+    header(out, "guerrilla_active_games", "gauge", "Sessions playing a game");
+    out.append("guerrilla_active_games " + QByteArray::number(playing) + "\n");
+    header(out, "guerrilla_searches_in_flight", "gauge", "Sessions choosing a turn");
+    out.append("guerrilla_searches_in_flight " + QByteArray::number(searching) + "\n");
+
+    //one metric after the other, for all the sessions
+    struct Gauge{
+        const char *name;
+        const char *type;
+        const char *help;
+        double (*value)(const SessionMetrics &);
+    };
+    const Gauge gauges[] = {
+        {"guerrilla_turns_total", "counter", "Turns played",
+         [](const SessionMetrics &m){ return double(m.turns); }},
+        {"guerrilla_search_nodes_total", "counter", "Positions searched",
+         [](const SessionMetrics &m){ return double(m.nodes); }},
+        {"guerrilla_search_seconds_total", "counter", "Time taken by the engine",
+         [](const SessionMetrics &m){ return m.searchTime / 1e6; }},
+        {"guerrilla_nodes_per_second", "gauge", "Speed of the last search",
+         [](const SessionMetrics &m){ return m.nodesPerSecond; }},
+        {"guerrilla_table_usage_ratio", "gauge", "Part of the transposition table filled",
+         [](const SessionMetrics &m){ return m.tableUsage; }},
+        {"guerrilla_memory_bytes", "gauge", "Bytes held by the battlefield, transposition table and last search",
+         [](const SessionMetrics &m){ return double(m.memory); }}
+    };
+    for(const Gauge &gauge : gauges){
+        header(out, gauge.name, gauge.type, gauge.help);
+        for(const auto &session : mSessions)sample(out, gauge.name, label(session.first), gauge.value(session.second));
+    }
+
+    header(out, "guerrilla_turn_latency_seconds", "summary", "Time from your_turn to end_turn, by part");
+    for(const auto &session : mSessions){
+        const TurnLatencies &latencies = session.second.latencies;
+        const std::pair<const char *, const LatencyHistogram *> parts[] = {
+            {"queue", &latencies.queue}, {"search", &latencies.search},
+            {"send", &latencies.send}, {"total", &latencies.total}
+        };
+        for(const auto &part : parts){
+            const QByteArray labels = label(session.first) + ",part=\"" + part.first + "\"";
+            sample(out, "guerrilla_turn_latency_seconds", labels + ",quantile=\"0.5\"", part.second->percentile(50.) / 1e6);
+            sample(out, "guerrilla_turn_latency_seconds", labels + ",quantile=\"0.99\"", part.second->percentile(99.) / 1e6);
+            sample(out, "guerrilla_turn_latency_seconds", labels + ",quantile=\"1\"", part.second->getMax() / 1e6);
+            sample(out, "guerrilla_turn_latency_seconds_sum", labels, part.second->getSum() / 1e6);
+            sample(out, "guerrilla_turn_latency_seconds_count", labels, double(part.second->getCount()));
+        }
+    }
+    return out;
+}
@@ -0,0 +1,132 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   metrics.hpp
+ * Author: azarias
+ *
+ * Created on 12/3/2018
+ */
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <QByteArray>
+#include <QString>
+
+#include <map>
+#include <mutex>
+
+#include "latency.hpp"
+
+/**
+ * @brief The SessionMetrics struct
+ * what a game session publishes about itself
+ */
+struct SessionMetrics{
+    /**
+     * @brief playing wether the game started and is not over
+     */
+    bool playing = false;
+
+    /**
+     * @brief searching wether the engine is choosing a turn
+     */
+    bool searching = false;
+
+    /**
+     * @brief turns turns played
+     */
+    quint64 turns = 0;
+
+    /**
+     * @brief nodes positions searched by all the turns
+     */
+    quint64 nodes = 0;
+
+    /**
+     * @brief searchTime time taken by the engine for all the turns, in microseconds
+     */
+    qint64 searchTime = 0;
+
+    /**
+     * @brief nodesPerSecond speed of the last search
+     */
+    double nodesPerSecond = 0.;
+
+    /**
+     * @brief tableUsage part of the transposition table filled
+     */
+    double tableUsage = 0.;
+
+    /**
+     * @brief memory bytes held by the session : battlefield,
+     * transposition table and most bytes held by the last search
+     */
+    quint64 memory = 0;
+
+    TurnLatencies latencies;
+};
+
+/**
+ * @brief The MetricsRegistry class
+ * the metrics of all the sessions of the process, updated by the
+ * sessions and read by the metrics server (from any thread)
+ */
+class MetricsRegistry
+{
+public:
+    /**
+     * @brief update replaces the metrics of the given session
+     * @param session name of the session (unique in the process)
+     * @param metrics
+     */
+    void update(const QString &session, const SessionMetrics &metrics);
+
+    /**
+     * @brief setSearching marks the start or end of a search
+     * (without copying all the metrics)
+     * @param session
+     * @param searching
+     */
+    void setSearching(const QString &session, bool searching);
+
+    /**
+     * @brief remove forgets the given session
+     * @param session
+     */
+    void remove(const QString &session);
+
+    /**
+     * @brief exposition
+     * @return all the metrics, in the prometheus text format
+     */
+    QByteArray exposition() const;
+
+private:
+    mutable std::mutex mMutex;
+
+    std::map<QString, SessionMetrics> mSessions;
+};
+
+#endif // METRICS_HPP
@@ -0,0 +1,106 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   metricsserver.cpp
+ * Author: azarias
+ *
+ * Created on 12/3/2018
+ */
+#include "metricsserver.hpp"
+
+#include <QDebug>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+namespace {
+
+/**
+ * @brief MAX_REQUEST bytes of a request, the connection is closed after
+ */
+const int MAX_REQUEST = 8192;
+
+/**
+ * @brief response a whole http response
+ * @param status
+ * @param body
+ * @return
+ */
+QByteArray response(const char *status, const QByteArray &body)
+{
+    return QByteArray("HTTP/1.0 ") + status + "\r\n"
+            "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+            "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+            "Connection: close\r\n\r\n" + body;
+}
+
+}
+
+MetricsServer::MetricsServer(const MetricsRegistry &registry, quint16 port):
+    mRegistry(registry),
+    mPort(port)
+{
+    start();
+}
+
+MetricsServer::~MetricsServer()
+{
+    quit();
+    wait();
+}
+
+void MetricsServer::run()
+{
+    //created here : the server and its sockets belong to this thread
+    QTcpServer server;
+    if(!server.listen(QHostAddress::LocalHost, mPort)){
+        qWarning() << "Could not serve the metrics on port" << mPort << ":" << server.errorString();
+        return;
+    }
+
+    connect(&server, &QTcpServer::newConnection, &server, [this, &server](){
+        while(QTcpSocket *socket = server.nextPendingConnection()){
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            connect(socket, &QTcpSocket::readyRead, socket, [this, socket](){
+                //answered once the headers are there (the request has no body)
+                if(socket->bytesAvailable() > MAX_REQUEST){
+                    socket->abort();
+                    return;
+                }
+                QByteArray request = socket->peek(MAX_REQUEST);
+                if(!request.contains("\r\n\r\n"))return;
+                socket->readAll();
+
+                if(request.startsWith("GET /metrics ") || request.startsWith("GET / ")){
+                    socket->write(response("200 OK", mRegistry.exposition()));
+                }else{
+                    socket->write(response("404 Not Found", "only /metrics\n"));
+                }
+                socket->disconnectFromHost();
+            });
+        }
+    });
+
+    exec();
+}
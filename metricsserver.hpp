@@ -0,0 +1,71 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   metricsserver.hpp
+ * Author: azarias
+ *
+ * Created on 12/3/2018
+ */
+#ifndef METRICSSERVER_HPP
+#define METRICSSERVER_HPP
+
+#include <QThread>
+
+#include "metrics.hpp"
+
+/**
+ * @brief The MetricsServer class
+ * answers the http requests of /metrics on the loopback with the
+ * metrics of the registry (prometheus text format).
+ * It has its own thread : the metrics can be scraped while the
+ * thread of the game is searching
+ */
+class MetricsServer : public QThread
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief MetricsServer starts listening
+     * @param registry must outlive the server
+     * @param port
+     */
+    MetricsServer(const MetricsRegistry &registry, quint16 port);
+
+    /**
+     * @brief ~MetricsServer stops the server and waits for its thread
+     */
+    ~MetricsServer();
+
+protected:
+    void run() override;
+
+private:
+    const MetricsRegistry &mRegistry;
+
+    quint16 mPort;
+};
+
+#endif // METRICSSERVER_HPP
@@ -0,0 +1,168 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   movegenerator.cpp
+ * Author: azarias
+ *
+ * Created on 8/3/2018
+ */
+#include "movegenerator.hpp"
+#include "targets.hpp"
+
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief THREATENED_PENALTY sort key removed from the moves
+ * to a field the opponent can attack (more than any history score)
+ */
+const qint64 THREATENED_PENALTY = qint64(1) << 32;
+
+bool compareKeys(const std::pair<qint64, quint32> &a, const std::pair<qint64, quint32> &b)
+{
+    return a.first > b.first;
+}
+
+}
+
+MoveGenerator::MoveGenerator(const BattleField &field, const HistoryTable &history, quint32 tableTurn):
+    mField(field),
+    mHistory(history),
+    mTableTurn(tableTurn && isLegal(tableTurn) ? tableTurn : 0)
+{
+
+}
+
+bool MoveGenerator::next(Turn &turn)
+{
+    for(;;){
+        switch(mStage){
+        case START:
+            mStage = TABLE;
+            if(mTableTurn){
+                turn = Turn::unpack(mTableTurn);
+                return true;
+            }
+            break;
+        case TABLE:
+            mStage = GOOD_ATTACKS;
+            generateAttacks();
+            break;
+        case GOOD_ATTACKS:
+        case BAD_ATTACKS:
+        case QUIETS:
+            while(mNext < mTurns.size()){
+                quint32 packed = mTurns[mNext++].second;
+                if(packed == mTableTurn)continue;//already given by the table stage
+                turn = Turn::unpack(packed);
+                return true;
+            }
+            if(mStage == GOOD_ATTACKS){
+                mStage = BAD_ATTACKS;
+                mTurns.swap(mBadAttacks);
+                mNext = 0;
+                std::stable_sort(mTurns.begin(), mTurns.end(), compareKeys);
+            }else if(mStage == BAD_ATTACKS){
+                mStage = QUIETS;
+                generateQuiets();
+            }else{
+                mStage = DONE;
+            }
+            break;
+        case DONE:
+            return false;
+        }
+    }
+}
+
+bool MoveGenerator::isLegal(quint32 packed) const
+{
+    const quint16 from = packed & 0x3FF;
+    const quint16 to = (packed >> 10) & 0x3FF;
+    if(from >= Geometry::SIZE || to >= Geometry::SIZE)return false;
+
+    const std::shared_ptr<Unit> &unit = mField.unitAt(from);
+    if(!unit || unit->getColor() != mField.getId() || mField.unitAt(to))return false;
+
+    const TargetList &moves = Targets::moves(unit->getType(), from);
+    if(std::find(moves.begin(), moves.end(), to) == moves.end())return false;
+
+    if(!(packed & (1u << 20)))return true;
+
+    const quint16 target = packed >> 21;
+    if(target >= Geometry::SIZE)return false;
+    const std::shared_ptr<Unit> &attacked = mField.unitAt(target);
+    if(!attacked || attacked->getColor() == unit->getColor())return false;
+
+    const TargetList &attacks = Targets::attacks(unit->getType(), unit->getColor(), to);
+    return std::find(attacks.begin(), attacks.end(), target) != attacks.end();
+}
+
+void MoveGenerator::generateAttacks()
+{
+    mTurns.clear();
+    mBadAttacks.clear();
+    mNext = 0;
+    const Unit::COLOR opponent = static_cast<Unit::COLOR>(1 - mField.getId());
+    for(const std::shared_ptr<Unit> &unit : mField.getMyUnits()){
+        const quint16 from = unit->getPosition().index();
+        const float value = BattleField::unitValue(unit->getType());
+        for(quint16 to : Targets::moves(unit->getType(), from)){
+            if(mField.unitAt(to))continue;
+
+            const bool safe = !mField.threats(opponent, Coordinates::fromIndex(to));
+            for(quint16 target : Targets::attacks(unit->getType(), unit->getColor(), to)){
+                const std::shared_ptr<Unit> &attacked = mField.unitAt(target);
+                if(attacked && attacked->getColor() != unit->getColor()){
+                    const float targetValue = BattleField::unitValue(attacked->getType());
+                    std::vector<std::pair<qint64, quint32>> &turns = safe || targetValue >= value ? mTurns : mBadAttacks;
+                    turns.emplace_back(qint64(targetValue), Turn::pack(from, to, target));
+                }
+            }
+        }
+    }
+    std::stable_sort(mTurns.begin(), mTurns.end(), compareKeys);
+}
+
+void MoveGenerator::generateQuiets()
+{
+    mTurns.clear();
+    mNext = 0;
+    const Unit::COLOR color = static_cast<Unit::COLOR>(mField.getId());
+    const Unit::COLOR opponent = static_cast<Unit::COLOR>(1 - mField.getId());
+    for(const std::shared_ptr<Unit> &unit : mField.getMyUnits()){
+        const Coordinates &from = unit->getPosition();
+        for(quint16 to : Targets::moves(unit->getType(), from.index())){
+            if(mField.unitAt(to))continue;
+
+            const Coordinates destination = Coordinates::fromIndex(to);
+            qint64 key = mHistory.score(color, from, destination);
+            if(mField.threats(opponent, destination))key -= THREATENED_PENALTY;
+            mTurns.emplace_back(key, Turn::pack(from.index(), to));
+        }
+    }
+    std::stable_sort(mTurns.begin(), mTurns.end(), compareKeys);
+}
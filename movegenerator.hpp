@@ -0,0 +1,137 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   movegenerator.hpp
+ * Author: azarias
+ *
+ * Created on 8/3/2018
+ */
+#ifndef MOVEGENERATOR_HPP
+#define MOVEGENERATOR_HPP
+
+#include <vector>
+
+#include "action.hpp"
+#include "battlefield.hpp"
+#include "searchcache.hpp"
+
+/**
+ * @brief The MoveGenerator class
+ * gives the turns of a position one by one, best ones first,
+ * by stages : the turn of the transposition table, the attacks on
+ * high-value targets (worth at least the attacker, or attacked from a
+ * field the opponent can't reach), the remaining attacks (both on the
+ * most valuable units first) then the moves without attack
+ * (sorted by history, the moves to a threatened field last).
+ * A stage is only generated when the previous one is over,
+ * so a cutoff on the first turns saves the generation of the others
+ */
+class MoveGenerator
+{
+public:
+    /**
+     * @brief The STAGE enum the stages, in the order they are given
+     */
+    enum STAGE {START, TABLE, GOOD_ATTACKS, BAD_ATTACKS, QUIETS, DONE};
+
+    /**
+     * @brief MoveGenerator
+     * @param field the position, for the player of its id (must outlive the generator)
+     * @param history the history of the player's moves
+     * @param tableTurn the packed turn of the transposition table (0 if none)
+     */
+    MoveGenerator(const BattleField &field, const HistoryTable &history, quint32 tableTurn);
+
+    /**
+     * @brief next the next turn to search
+     * @param turn set to the turn
+     * @return false when there is no turn left
+     */
+    bool next(Turn &turn);
+
+    /**
+     * @brief getStage
+     * @return the stage of the last turn given by next
+     */
+    STAGE getStage() const
+    {
+        return mStage;
+    }
+
+    /**
+     * @brief memoryUsage
+     * @return the bytes held by the generator (its turns included)
+     */
+    std::size_t memoryUsage() const
+    {
+        return sizeof(MoveGenerator) + (mTurns.capacity() + mBadAttacks.capacity()) * sizeof(mTurns[0]);
+    }
+
+private:
+    /**
+     * @brief isLegal
+     * @param packed
+     * @return wether the packed turn can be played on the field
+     * (the turn of the table may come from another position)
+     */
+    bool isLegal(quint32 packed) const;
+
+    /**
+     * @brief generateAttacks fills the turns with the moves followed by an attack
+     * on a high-value target, the other attacks are put aside for their stage
+     */
+    void generateAttacks();
+
+    /**
+     * @brief generateQuiets fills the turns with the moves without attack
+     */
+    void generateQuiets();
+
+    const BattleField &mField;
+
+    const HistoryTable &mHistory;
+
+    quint32 mTableTurn;
+
+    STAGE mStage = START;
+
+    /**
+     * @brief mTurns the packed turns of the current stage
+     * with their sort key, the best first
+     */
+    std::vector<std::pair<qint64, quint32>> mTurns;
+
+    /**
+     * @brief mBadAttacks the remaining attacks, sorted when their stage comes
+     */
+    std::vector<std::pair<qint64, quint32>> mBadAttacks;
+
+    /**
+     * @brief mNext index of the next turn of the current stage
+     */
+    std::size_t mNext = 0;
+};
+
+#endif // MOVEGENERATOR_HPP
@@ -0,0 +1,402 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   network.cpp
+ * Author: azarias
+ *
+ * Created on 9/3/2018
+ */
+#include "network.hpp"
+#include "battlefield.hpp"
+
+#include <QFile>
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+constexpr int Network::INPUTS;
+constexpr int Network::HIDDEN;
+constexpr int Network::DENSE;
+constexpr float Network::OUTPUT_SCALE;
+
+namespace {
+
+/**
+ * @brief fnv adds the given bytes to a FNV-1a hash
+ * @param hash
+ * @param data
+ * @param bytes
+ * @return
+ */
+quint64 fnv(quint64 hash, const void *data, std::size_t bytes)
+{
+    const unsigned char *next = static_cast<const unsigned char*>(data);
+    for(std::size_t i = 0; i < bytes; ++i)hash = (hash ^ next[i]) * 1099511628211ULL;
+    return hash;
+}
+
+/**
+ * @brief addRow adds a row of the first layer to the accumulator of a side
+ * @param values
+ * @param row
+ */
+void addRow(qint16 *values, const qint16 *row)
+{
+#if defined(__AVX2__)
+    for(int i = 0; i < Network::HIDDEN; i += 16){
+        __m256i *v = reinterpret_cast<__m256i*>(values + i);
+        _mm256_storeu_si256(v, _mm256_add_epi16(_mm256_loadu_si256(v), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i))));
+    }
+#elif defined(__SSE2__)
+    for(int i = 0; i < Network::HIDDEN; i += 8){
+        __m128i *v = reinterpret_cast<__m128i*>(values + i);
+        _mm_storeu_si128(v, _mm_add_epi16(_mm_loadu_si128(v), _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i))));
+    }
+#else
+    for(int i = 0; i < Network::HIDDEN; ++i)values[i] += row[i];
+#endif
+}
+
+/**
+ * @brief subRow removes a row of the first layer from the accumulator of a side
+ * @param values
+ * @param row
+ */
+void subRow(qint16 *values, const qint16 *row)
+{
+#if defined(__AVX2__)
+    for(int i = 0; i < Network::HIDDEN; i += 16){
+        __m256i *v = reinterpret_cast<__m256i*>(values + i);
+        _mm256_storeu_si256(v, _mm256_sub_epi16(_mm256_loadu_si256(v), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i))));
+    }
+#elif defined(__SSE2__)
+    for(int i = 0; i < Network::HIDDEN; i += 8){
+        __m128i *v = reinterpret_cast<__m128i*>(values + i);
+        _mm_storeu_si128(v, _mm_sub_epi16(_mm_loadu_si128(v), _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i))));
+    }
+#else
+    for(int i = 0; i < Network::HIDDEN; ++i)values[i] -= row[i];
+#endif
+}
+
+/**
+ * @brief activate clips the given values to [0, ACTIVATION]
+ * @param values
+ * @param size multiple of 16
+ * @param out
+ */
+void activate(const qint16 *values, int size, qint16 *out)
+{
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(Network::ACTIVATION);
+    for(int i = 0; i < size; i += 16){
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_min_epi16(_mm256_max_epi16(v, zero), one));
+    }
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(Network::ACTIVATION);
+    for(int i = 0; i < size; i += 8){
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_min_epi16(_mm_max_epi16(v, zero), one));
+    }
+#else
+    for(int i = 0; i < size; ++i)out[i] = std::min<qint16>(std::max<qint16>(values[i], 0), Network::ACTIVATION);
+#endif
+}
+
+/**
+ * @brief dot
+ * @param a
+ * @param b
+ * @param size multiple of 16
+ * @return the dot product of a and b, on 32 bits
+ */
+qint32 dot(const qint16 *a, const qint16 *b, int size)
+{
+#if defined(__AVX2__)
+    __m256i sum = _mm256_setzero_si256();
+    for(int i = 0; i < size; i += 16){
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+                                                      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i))));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half);
+#elif defined(__SSE2__)
+    __m128i sum = _mm_setzero_si128();
+    for(int i = 0; i < size; i += 8){
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                                                _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i))));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+#else
+    qint32 sum = 0;
+    for(int i = 0; i < size; ++i)sum += qint32(a[i]) * b[i];
+    return sum;
+#endif
+}
+
+/**
+ * @brief dense the second layer : for each output, its bias plus the
+ * dot product of the input and its weights. The weights are interleaved
+ * by pairs of inputs (see Network::mDense) so that each pair of inputs is
+ * multiplied with all the outputs at once, without horizontal sums
+ * @param input 2 HIDDEN inputs
+ * @param weights
+ * @param bias DENSE biases
+ * @param out DENSE outputs
+ */
+void dense(const qint16 *input, const qint16 *weights, const qint32 *bias, qint32 *out)
+{
+    const int pairs = Network::HIDDEN;
+#if defined(__AVX2__)
+    __m256i sums[Network::DENSE / 8];
+    for(int j = 0; j < Network::DENSE / 8; ++j)sums[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bias + 8 * j));
+    for(int p = 0; p < pairs; ++p){
+        qint32 pair;
+        std::memcpy(&pair, input + 2 * p, sizeof(pair));
+        const __m256i in = _mm256_set1_epi32(pair);
+        const qint16 *row = weights + p * 2 * Network::DENSE;
+        for(int j = 0; j < Network::DENSE / 8; ++j){
+            sums[j] = _mm256_add_epi32(sums[j], _mm256_madd_epi16(in, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + 16 * j))));
+        }
+    }
+    for(int j = 0; j < Network::DENSE / 8; ++j)_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 8 * j), sums[j]);
+#elif defined(__SSE2__)
+    __m128i sums[Network::DENSE / 4];
+    for(int j = 0; j < Network::DENSE / 4; ++j)sums[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bias + 4 * j));
+    for(int p = 0; p < pairs; ++p){
+        qint32 pair;
+        std::memcpy(&pair, input + 2 * p, sizeof(pair));
+        const __m128i in = _mm_set1_epi32(pair);
+        const qint16 *row = weights + p * 2 * Network::DENSE;
+        for(int j = 0; j < Network::DENSE / 4; ++j){
+            sums[j] = _mm_add_epi32(sums[j], _mm_madd_epi16(in, _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 8 * j))));
+        }
+    }
+    for(int j = 0; j < Network::DENSE / 4; ++j)_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * j), sums[j]);
+#else
+    std::copy(bias, bias + Network::DENSE, out);
+    for(int p = 0; p < pairs; ++p){
+        const qint16 *row = weights + p * 2 * Network::DENSE;
+        for(int j = 0; j < Network::DENSE; ++j){
+            out[j] += qint32(input[2 * p]) * row[2 * j] + qint32(input[2 * p + 1]) * row[2 * j + 1];
+        }
+    }
+#endif
+}
+
+/**
+ * @brief quantize
+ * @param value
+ * @param scale
+ * @return the value times the scale, rounded and clipped to 16 bits
+ */
+qint16 quantize(float value, float scale)
+{
+    return qint16(std::max(-32767.f, std::min(32767.f, std::round(value * scale))));
+}
+
+}
+
+Network::Weights::Weights():
+    feature(INPUTS * HIDDEN, 0.f),
+    featureBias(HIDDEN, 0.f),
+    dense(DENSE * 2 * HIDDEN, 0.f),
+    denseBias(DENSE, 0.f),
+    output(DENSE, 0.f)
+{
+}
+
+Network::Network():
+    mFeature(INPUTS * HIDDEN, 0),
+    mFeatureBias(HIDDEN, 0),
+    mDense(DENSE * 2 * HIDDEN, 0),
+    mDenseBias(DENSE, 0),
+    mOutput(DENSE, 0)
+{
+}
+
+bool Network::load(const QString &path)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))return false;
+
+    const QByteArray data = file.readAll();
+    const qint64 expected = sizeof(Header) + (mFeature.size() + mFeatureBias.size() + mDense.size() + mOutput.size()) * sizeof(qint16) +
+            (mDenseBias.size() + 1) * sizeof(qint32);
+    Header header = {};
+    if(data.size() >= (int)sizeof(Header))std::memcpy(&header, data.constData(), sizeof(Header));
+    if(qint64(data.size()) != expected || header.magic != mMagic || header.version != mVersion ||
+            header.width != Geometry::WIDTH || header.height != Geometry::HEIGHT ||
+            header.hidden != HIDDEN || header.dense != DENSE){
+        qWarning() << "Invalid network" << path;
+        return false;
+    }
+
+    const char *next = data.constData() + sizeof(Header);
+    auto read = [&next](void *values, std::size_t bytes){
+        std::memcpy(values, next, bytes);
+        next += bytes;
+    };
+    read(mFeature.data(), mFeature.size() * sizeof(qint16));
+    read(mFeatureBias.data(), mFeatureBias.size() * sizeof(qint16));
+    read(mDense.data(), mDense.size() * sizeof(qint16));
+    read(mDenseBias.data(), mDenseBias.size() * sizeof(qint32));
+    read(mOutput.data(), mOutput.size() * sizeof(qint16));
+    read(&mOutputBias, sizeof(qint32));
+    return true;
+}
+
+bool Network::save(const QString &path) const
+{
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))return false;
+
+    Header header = {mMagic, mVersion, Geometry::WIDTH, Geometry::HEIGHT, HIDDEN, DENSE};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char*>(mFeature.data()), mFeature.size() * sizeof(qint16));
+    file.write(reinterpret_cast<const char*>(mFeatureBias.data()), mFeatureBias.size() * sizeof(qint16));
+    file.write(reinterpret_cast<const char*>(mDense.data()), mDense.size() * sizeof(qint16));
+    file.write(reinterpret_cast<const char*>(mDenseBias.data()), mDenseBias.size() * sizeof(qint32));
+    file.write(reinterpret_cast<const char*>(mOutput.data()), mOutput.size() * sizeof(qint16));
+    return file.write(reinterpret_cast<const char*>(&mOutputBias), sizeof(qint32)) == sizeof(qint32);
+}
+
+quint64 Network::checksum() const
+{
+    quint64 hash = 14695981039346656037ULL;
+    hash = fnv(hash, mFeature.data(), mFeature.size() * sizeof(qint16));
+    hash = fnv(hash, mFeatureBias.data(), mFeatureBias.size() * sizeof(qint16));
+    hash = fnv(hash, mDense.data(), mDense.size() * sizeof(qint16));
+    hash = fnv(hash, mDenseBias.data(), mDenseBias.size() * sizeof(qint32));
+    hash = fnv(hash, mOutput.data(), mOutput.size() * sizeof(qint16));
+    return fnv(hash, &mOutputBias, sizeof(qint32));
+}
+
+void Network::setWeights(const Weights &weights)
+{
+    const float weightScale = 1 << WEIGHT_SHIFT;
+    for(std::size_t i = 0; i < mFeature.size(); ++i)mFeature[i] = quantize(weights.feature[i], ACTIVATION);
+    for(std::size_t i = 0; i < mFeatureBias.size(); ++i)mFeatureBias[i] = quantize(weights.featureBias[i], ACTIVATION);
+    for(int j = 0; j < DENSE; ++j){
+        for(int i = 0; i < 2 * HIDDEN; ++i){
+            mDense[((i / 2) * DENSE + j) * 2 + i % 2] = quantize(weights.dense[j * 2 * HIDDEN + i], weightScale);
+        }
+    }
+    for(std::size_t i = 0; i < mDenseBias.size(); ++i)mDenseBias[i] = qint32(std::round(weights.denseBias[i] * ACTIVATION * weightScale));
+    for(std::size_t i = 0; i < mOutput.size(); ++i)mOutput[i] = quantize(weights.output[i], weightScale);
+    mOutputBias = qint32(std::round(weights.outputBias * ACTIVATION * weightScale));
+}
+
+void Network::refresh(const BattleField &field, Accumulator &accumulator) const
+{
+    reset(accumulator);
+    for(const std::shared_ptr<Unit> &unit : field.getUnits())addUnit(accumulator, *unit);
+}
+
+void Network::reset(Accumulator &accumulator) const
+{
+    for(std::array<qint16, HIDDEN> &values : accumulator.values){
+        std::copy(mFeatureBias.begin(), mFeatureBias.end(), values.begin());
+    }
+}
+
+void Network::addFeature(Accumulator &accumulator, Unit::COLOR side, int feature) const
+{
+    addRow(accumulator.values[side].data(), &mFeature[feature * HIDDEN]);
+}
+
+void Network::addUnit(Accumulator &accumulator, const Unit &unit) const
+{
+    for(int side = 0; side < 2; ++side){
+        const Unit::COLOR color = static_cast<Unit::COLOR>(side);
+        addFeature(accumulator, color, feature(color, unit.getColor(), unit.getType(), unit.getPosition().index()));
+    }
+}
+
+void Network::removeUnit(Accumulator &accumulator, const Unit &unit) const
+{
+    for(int side = 0; side < 2; ++side){
+        const int row = feature(static_cast<Unit::COLOR>(side), unit.getColor(), unit.getType(), unit.getPosition().index());
+        subRow(accumulator.values[side].data(), &mFeature[row * HIDDEN]);
+    }
+}
+
+void Network::moveUnit(Accumulator &accumulator, const Unit &unit, int from, int to) const
+{
+    for(int side = 0; side < 2; ++side){
+        const Unit::COLOR color = static_cast<Unit::COLOR>(side);
+        subRow(accumulator.values[side].data(), &mFeature[feature(color, unit.getColor(), unit.getType(), from) * HIDDEN]);
+        addRow(accumulator.values[side].data(), &mFeature[feature(color, unit.getColor(), unit.getType(), to) * HIDDEN]);
+    }
+}
+
+float Network::evaluate(const Accumulator &accumulator, Unit::COLOR player) const
+{
+    //the side of the player, then the one of the opponent
+    qint16 input[2 * HIDDEN];
+    activate(accumulator.values[player].data(), HIDDEN, input);
+    activate(accumulator.values[1 - player].data(), HIDDEN, input + HIDDEN);
+
+    qint32 sums[DENSE];
+    dense(input, mDense.data(), mDenseBias.data(), sums);
+    qint16 hidden[DENSE];
+    for(int i = 0; i < DENSE; ++i)hidden[i] = qint16(std::min(std::max(sums[i] >> WEIGHT_SHIFT, 0), qint32(ACTIVATION)));
+
+    const qint32 output = mOutputBias + dot(hidden, mOutput.data(), DENSE);
+    return output * (OUTPUT_SCALE / (ACTIVATION << WEIGHT_SHIFT));
+}
+
+float Network::evaluate(const BattleField &field, Unit::COLOR player) const
+{
+    Accumulator accumulator;
+    refresh(field, accumulator);
+    return evaluate(accumulator, player);
+}
+
+const char *Network::instructions()
+{
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
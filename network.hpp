@@ -0,0 +1,267 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   network.hpp
+ * Author: azarias
+ *
+ * Created on 9/3/2018
+ */
+#ifndef NETWORK_HPP
+#define NETWORK_HPP
+
+#include <QString>
+
+#include <array>
+#include <vector>
+
+#include "geometry.hpp"
+#include "unit.hpp"
+
+class BattleField;
+
+/**
+ * @brief The Network class
+ * a small neural network evaluating a battlefield (efficiently updatable :
+ * the first layer is a sum of the rows of the units of the field, kept in
+ * an accumulator and updated on each move and attack instead of computed again).
+ * The first layer is computed for both players, each one from its side of the
+ * board (the units of the player first, the lines mirrored for black), then
+ * two dense layers give the score of the player that has to play.
+ * All the layers use 16 bits integers, with AVX2 or SSE2 kernels (see simd.pri)
+ * and a scalar fallback. The weights are trained by Guerrilla-tuner --network
+ */
+class Network
+{
+public:
+    /**
+     * @brief INPUTS features of a side : a unit of a color and a type on a field
+     */
+    static constexpr int INPUTS = 2 * 3 * Geometry::SIZE;
+
+    /**
+     * @brief HIDDEN width of the accumulator of each side
+     */
+    static constexpr int HIDDEN = 64;
+
+    /**
+     * @brief DENSE width of the second layer
+     */
+    static constexpr int DENSE = 32;
+
+    /**
+     * @brief ACTIVATION the activations are clipped to [0, 1],
+     * stored as [0, ACTIVATION]
+     */
+    static constexpr int ACTIVATION = 127;
+
+    /**
+     * @brief WEIGHT_SHIFT the weights of the dense layers are
+     * stored multiplied by 2^WEIGHT_SHIFT
+     */
+    static constexpr int WEIGHT_SHIFT = 6;
+
+    /**
+     * @brief OUTPUT_SCALE score (in the units of the evaluation)
+     * of an output of 1
+     */
+    static constexpr float OUTPUT_SCALE = 400.f;
+
+    /**
+     * @brief The Accumulator struct the first layer of the network
+     * (before the activation), for each side
+     */
+    struct Accumulator{
+        std::array<std::array<qint16, HIDDEN>, 2> values;
+    };
+
+    /**
+     * @brief The Weights struct the weights of the network as floats
+     * (the training works on them, the network quantizes them)
+     */
+    struct Weights{
+        Weights();
+
+        std::vector<float> feature;//INPUTS x HIDDEN
+
+        std::vector<float> featureBias;//HIDDEN
+
+        std::vector<float> dense;//DENSE x 2 HIDDEN (a row per output)
+
+        std::vector<float> denseBias;//DENSE
+
+        std::vector<float> output;//DENSE
+
+        float outputBias = 0.f;
+    };
+
+    Network();
+
+    /**
+     * @brief load loads the network of the given file (written by save),
+     * made for the same battlefield size
+     * @param path
+     * @return wether the file was read
+     */
+    bool load(const QString &path);
+
+    /**
+     * @brief save writes the network
+     * @param path
+     * @return wether the file was written
+     */
+    bool save(const QString &path) const;
+
+    /**
+     * @brief checksum
+     * @return a hash of the parameters of the network
+     */
+    quint64 checksum() const;
+
+    /**
+     * @brief setWeights quantizes the given weights
+     * (they are clipped to what the integers can hold)
+     * @param weights
+     */
+    void setWeights(const Weights &weights);
+
+    /**
+     * @brief feature
+     * @param side the player whose view it is
+     * @param color color of the unit
+     * @param type type of the unit
+     * @param index the field of the unit
+     * @return the index of the feature
+     */
+    static int feature(Unit::COLOR side, Unit::COLOR color, Unit::TYPE type, int index)
+    {
+        if(side == Unit::BLACK)index = (Geometry::HEIGHT - 1 - index / Geometry::WIDTH) * Geometry::WIDTH + index % Geometry::WIDTH;
+        return ((color == side ? 0 : 3) + type) * Geometry::SIZE + index;
+    }
+
+    /**
+     * @brief refresh computes the accumulator of the given field
+     * @param field
+     * @param accumulator
+     */
+    void refresh(const BattleField &field, Accumulator &accumulator) const;
+
+    /**
+     * @brief reset sets the accumulator of an empty field
+     * @param accumulator
+     */
+    void reset(Accumulator &accumulator) const;
+
+    /**
+     * @brief addFeature adds a feature to the side of a player
+     * @param accumulator
+     * @param side
+     * @param feature
+     */
+    void addFeature(Accumulator &accumulator, Unit::COLOR side, int feature) const;
+
+    /**
+     * @brief addUnit a unit was added on its field
+     * @param accumulator
+     * @param unit
+     */
+    void addUnit(Accumulator &accumulator, const Unit &unit) const;
+
+    /**
+     * @brief removeUnit a unit was removed from its field
+     * @param accumulator
+     * @param unit
+     */
+    void removeUnit(Accumulator &accumulator, const Unit &unit) const;
+
+    /**
+     * @brief moveUnit a unit moved
+     * @param accumulator
+     * @param unit
+     * @param from
+     * @param to
+     */
+    void moveUnit(Accumulator &accumulator, const Unit &unit, int from, int to) const;
+
+    /**
+     * @brief evaluate
+     * @param accumulator
+     * @param player the player that has to play
+     * @return the score of the player
+     */
+    float evaluate(const Accumulator &accumulator, Unit::COLOR player) const;
+
+    /**
+     * @brief evaluate evaluates a field that does not follow
+     * the network (its accumulator is computed)
+     * @param field
+     * @param player
+     * @return
+     */
+    float evaluate(const BattleField &field, Unit::COLOR player) const;
+
+    /**
+     * @brief instructions
+     * @return the instructions the kernels were compiled for (avx2, sse2 or scalar)
+     */
+    static const char *instructions();
+
+private:
+    /**
+     * @brief The Header struct header of the network file
+     */
+    struct Header{
+        quint32 magic;
+        quint32 version;
+        quint32 width;
+        quint32 height;
+        quint32 hidden;
+        quint32 dense;
+    };
+
+    static const quint32 mMagic = 0x45554E4E;// "NNUE"
+
+    static const quint32 mVersion = 1;
+
+    /**
+     * @brief mFeature weights of the first layer, a row of HIDDEN per feature
+     */
+    std::vector<qint16> mFeature;
+
+    std::vector<qint16> mFeatureBias;
+
+    /**
+     * @brief mDense weights of the second layer, interleaved by pairs of
+     * inputs : for each pair, the weights of both inputs for each output
+     */
+    std::vector<qint16> mDense;
+
+    std::vector<qint32> mDenseBias;
+
+    std::vector<qint16> mOutput;
+
+    qint32 mOutputBias = 0;
+};
+
+#endif // NETWORK_HPP
@@ -0,0 +1,124 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   openingbook.cpp
+ * Author: azarias
+ *
+ * Created on 20/2/2018
+ */
+#include "openingbook.hpp"
+
+#include <algorithm>
+#include <QDebug>
+
+OpeningBook::OpeningBook()
+{
+
+}
+
+OpeningBook::~OpeningBook()
+{
+    close();
+}
+
+bool OpeningBook::open(const QString &path)
+{
+    close();
+
+    mFile.setFileName(path);
+    if(!mFile.open(QIODevice::ReadOnly))return false;
+
+    if(mFile.size() < (qint64)sizeof(Header)){
+        close();
+        return false;
+    }
+
+    const uchar *data = mFile.map(0, mFile.size());
+    if(!data){
+        close();
+        return false;
+    }
+
+    const Header *header = reinterpret_cast<const Header*>(data);
+    if(header->magic != mMagic || header->version != mVersion ||
+            mFile.size() != (qint64)(sizeof(Header) + header->size * sizeof(Entry))){
+        qWarning() << "Invalid opening book" << path;
+        close();
+        return false;
+    }
+
+    mSize = header->size;
+    mEntries = reinterpret_cast<const Entry*>(data + sizeof(Header));
+    return true;
+}
+
+void OpeningBook::close()
+{
+    mEntries = nullptr;
+    mSize = 0;
+    mFile.close();//also unmaps the file
+}
+
+bool OpeningBook::probe(const BattleField &field, Turn &turn) const
+{
+    if(!mEntries)return false;
+
+    //the book only contains the canonical positions (see Symmetry)
+    int symmetry;
+    const quint64 hash = field.canonicalHash(symmetry);
+    const Entry *end = mEntries + mSize;
+    const Entry *found = std::lower_bound(mEntries, end, hash, [](const Entry &entry, quint64 hash){
+        return entry.hash < hash;
+    });
+    if(found == end || found->hash != hash)return false;
+
+    //hash collision or corrupted book : the turn must be possible
+    const quint32 bookTurn = Symmetry::turn(symmetry, found->turn);
+    for(const Turn &possible : field.possibleTurns()){
+        if(possible.pack() == bookTurn){
+            turn = possible;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool OpeningBook::write(const QString &path, std::vector<Entry> entries)
+{
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b){
+        return a.hash < b.hash || (a.hash == b.hash && a.depth > b.depth);
+    });
+    entries.erase(std::unique(entries.begin(), entries.end(), [](const Entry &a, const Entry &b){
+        return a.hash == b.hash;
+    }), entries.end());
+
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))return false;
+
+    Header header = {mMagic, mVersion, entries.size()};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+    return true;
+}
@@ -0,0 +1,159 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   openingbook.hpp
+ * Author: azarias
+ *
+ * Created on 20/2/2018
+ */
+#ifndef OPENINGBOOK_HPP
+#define OPENINGBOOK_HPP
+
+#include <QFile>
+#include <QString>
+#include <vector>
+
+#include "action.hpp"
+#include "battlefield.hpp"
+
+/**
+ * @brief The OpeningBook class
+ * read-only opening book : the file contains
+ * the best turn of a lot of positions (computed offline
+ * with a deep search) sorted by the hash of the position.
+ * The file is memory-mapped, a probe is a binary search
+ */
+class OpeningBook
+{
+public:
+    /**
+     * @brief The Entry struct
+     * an entry of the book, as written in the file
+     */
+    struct Entry{
+        /**
+         * @brief hash canonical hash of the position (see BattleField::canonicalHash)
+         */
+        quint64 hash;
+
+        /**
+         * @brief turn the best turn (see Turn::pack), in the canonical position
+         */
+        quint32 turn;
+
+        /**
+         * @brief depth depth of the search that found the turn
+         */
+        quint8 depth;
+
+        quint8 padding[3];
+    };
+
+    OpeningBook();
+
+    ~OpeningBook();
+
+    /**
+     * @brief open maps the book file in memory
+     * @param path
+     * @return wether the file is a valid book
+     */
+    bool open(const QString &path);
+
+    /**
+     * @brief close unmaps the book file
+     */
+    void close();
+
+    /**
+     * @brief isOpen
+     * @return wether a book is opened
+     */
+    bool isOpen() const
+    {
+        return mEntries != nullptr;
+    }
+
+    /**
+     * @brief size the number of positions in the book
+     * @return
+     */
+    std::size_t size() const
+    {
+        return mSize;
+    }
+
+    /**
+     * @brief probe looks for the given field in the book
+     * @param field
+     * @param turn set to the book's turn when the position is found
+     * @return wether a legal turn was found for this position
+     */
+    bool probe(const BattleField &field, Turn &turn) const;
+
+    /**
+     * @brief write writes a book file with the given entries
+     * (the entries are sorted, and only the deepest entry
+     * of a position is kept)
+     * @param path
+     * @param entries
+     * @return wether the file could be written
+     */
+    static bool write(const QString &path, std::vector<Entry> entries);
+
+private:
+    /**
+     * @brief The Header struct header of the book file
+     */
+    struct Header{
+        quint32 magic;
+        quint32 version;
+        quint64 size;
+    };
+
+    static const quint32 mMagic = 0x4B4F4F42;// "BOOK"
+
+    static const quint32 mVersion = 2;// 2 : canonical hashes
+
+    /**
+     * @brief mFile the mapped file
+     */
+    QFile mFile;
+
+    /**
+     * @brief mEntries the entries of the book,
+     * pointing into the mapped file
+     */
+    const Entry *mEntries = nullptr;
+
+    /**
+     * @brief mSize number of entries
+     */
+    std::size_t mSize = 0;
+};
+
+static_assert(sizeof(OpeningBook::Entry) == 16, "Book entries must be 16 bytes long");
+
+#endif // OPENINGBOOK_HPP
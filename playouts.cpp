@@ -0,0 +1,193 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   playouts.cpp
+ * Author: azarias
+ *
+ * Created on 10/3/2018
+ */
+#include "playouts.hpp"
+#include "targets.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+
+const quint16 Playouts::EMPTY;
+
+Playouts::Playouts(int games, quint64 seed):
+    mGames(games),
+    mOver(games, 0),
+    mUnit(games, EMPTY),
+    mTo(games, 0),
+    mRandom(games)
+{
+    //splitmix : the games don't start with close states
+    for(int game = 0; game < mGames; ++game){
+        quint64 z = seed + (game + 1) * 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        mRandom[game] = (z ^ (z >> 31)) | 1;
+    }
+}
+
+float Playouts::run(const BattleField &field, int maxTurns)
+{
+    GUERRILLA_TRACE("playouts");
+    load(field);
+    mPlayer = field.getId() == Unit::BLACK ? Unit::BLACK : Unit::WHITE;
+    mWins = mDraws = mLosses = 0;
+    mTurns = 0;
+
+    const int opponent = 1 - mPlayer;
+    if(mFirst[mPlayer + 1] == mFirst[mPlayer] || mFirst[opponent + 1] == mFirst[opponent]){
+        //a player has no unit left
+        (mFirst[mPlayer + 1] == mFirst[mPlayer] ? mLosses : mWins) = mGames;
+        return mWins / float(mGames);
+    }
+
+    mPlaying = mGames;
+    Unit::COLOR color = mPlayer;
+    for(int turn = 0; turn < maxTurns && mPlaying > 0; ++turn){
+        mTurns += mPlaying;
+        chooseMoves(color);
+        play(color);
+        color = color == Unit::WHITE ? Unit::BLACK : Unit::WHITE;
+    }
+    mDraws = mPlaying;
+    return (mWins + 0.5f * mDraws) / mGames;
+}
+
+void Playouts::load(const BattleField &field)
+{
+    //the units sorted by color
+    mTypes.clear();
+    std::vector<quint16> fields;
+    for(int color = 0; color < 2; ++color){
+        mFirst[color] = mTypes.size();
+        for(const std::shared_ptr<Unit> &unit : field.getUnits()){
+            if(unit->getColor() != color)continue;
+            mTypes.push_back(unit->getType());
+            fields.push_back(unit->getPosition().index());
+        }
+    }
+    mFirst[2] = mUnits = mTypes.size();
+
+    mFields.resize(mUnits * mGames);
+    mBoard.assign(Geometry::SIZE * mGames, EMPTY);
+    for(int unit = 0; unit < mUnits; ++unit){
+        std::fill_n(&mFields[unit * mGames], mGames, fields[unit]);
+        std::fill_n(&mBoard[fields[unit] * mGames], mGames, unit);
+    }
+    for(int color = 0; color < 2; ++color)mAlive[color].assign(mGames, mFirst[color + 1] - mFirst[color]);
+    std::fill(mOver.begin(), mOver.end(), 0);
+}
+
+void Playouts::chooseMoves(Unit::COLOR color)
+{
+    const int first = mFirst[color];
+    const int count = mFirst[color + 1] - first;
+    std::fill(mUnit.begin(), mUnit.end(), EMPTY);
+
+    //a random unit to a random field, in all the games at once :
+    //most of the time, the unit is alive and the field is free
+    for(int round = 0; round < ROUNDS; ++round){
+        for(int game = 0; game < mGames; ++game){
+            if(mOver[game] || mUnit[game] != EMPTY)continue;
+            const quint32 r = random(game);
+            const int unit = first + r % count;
+            const quint16 from = mFields[unit * mGames + game];
+            if(from == EMPTY)continue;
+
+            const TargetList &moves = Targets::moves(mTypes[unit], from);
+            const quint16 to = moves.fields[(r >> 16) % moves.size];
+            if(mBoard[to * mGames + game] == EMPTY){
+                mUnit[game] = unit;
+                mTo[game] = to;
+            }
+        }
+    }
+
+    for(int game = 0; game < mGames; ++game){
+        if(!mOver[game] && mUnit[game] == EMPTY)findMove(game, color);
+    }
+}
+
+bool Playouts::findMove(int game, Unit::COLOR color)
+{
+    const int first = mFirst[color];
+    const int count = mFirst[color + 1] - first;
+    const quint32 r = random(game);
+    for(int i = 0; i < count; ++i){
+        const int unit = first + (r + i) % count;
+        const quint16 from = mFields[unit * mGames + game];
+        if(from == EMPTY)continue;
+
+        const TargetList &moves = Targets::moves(mTypes[unit], from);
+        for(int m = 0; m < moves.size; ++m){
+            const quint16 to = moves.fields[((r >> 16) + m) % moves.size];
+            if(mBoard[to * mGames + game] == EMPTY){
+                mUnit[game] = unit;
+                mTo[game] = to;
+                return true;
+            }
+        }
+    }
+    return false;//blocked : the player passes
+}
+
+void Playouts::play(Unit::COLOR color)
+{
+    const int opponent = 1 - color;
+    const int firstVictim = mFirst[opponent];
+    const int lastVictim = mFirst[opponent + 1];
+
+    for(int game = 0; game < mGames; ++game){
+        const quint16 unit = mUnit[game];
+        if(mOver[game] || unit == EMPTY)continue;
+
+        quint16 &from = mFields[unit * mGames + game];
+        const quint16 to = mTo[game];
+        mBoard[from * mGames + game] = EMPTY;
+        mBoard[to * mGames + game] = unit;
+        from = to;
+
+        quint16 targets[16];
+        int found = 0;
+        for(quint16 target : Targets::attacks(mTypes[unit], color, to)){
+            const quint16 victim = mBoard[target * mGames + game];
+            if(victim >= firstVictim && victim < lastVictim)targets[found++] = target;
+        }
+        if(!found)continue;
+
+        const quint16 target = targets[random(game) % found];
+        mFields[mBoard[target * mGames + game] * mGames + game] = EMPTY;
+        mBoard[target * mGames + game] = EMPTY;
+        if(--mAlive[opponent][game] == 0){
+            mOver[game] = 1;
+            --mPlaying;
+            ++(color == mPlayer ? mWins : mLosses);
+        }
+    }
+}
@@ -0,0 +1,218 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   playouts.hpp
+ * Author: azarias
+ *
+ * Created on 10/3/2018
+ */
+#ifndef PLAYOUTS_HPP
+#define PLAYOUTS_HPP
+
+#include <QtGlobal>
+
+#include <vector>
+
+#include "battlefield.hpp"
+
+/**
+ * @brief The Playouts class
+ * plays many random games (playouts) from the same battlefield at once,
+ * to estimate the chances of the player (Monte Carlo evaluation).
+ * The games don't use BattleField (its copies and shared pointers cost
+ * more than the turns), they are stored as a structure of arrays :
+ * for each unit, its field in each game, and for each field of the
+ * battlefield, its unit in each game. All the games play the same turn
+ * at the same time, each step of the turn is a loop over the games
+ * on contiguous arrays.
+ * The playout policy : a random unit moves to a random free field,
+ * then attacks a random opponent unit if it can
+ */
+class Playouts
+{
+public:
+    /**
+     * @brief Playouts
+     * @param games number of games played at once
+     * @param seed seed of the random turns
+     */
+    explicit Playouts(int games, quint64 seed = 1);
+
+    /**
+     * @brief run plays the games from the given field, the player
+     * of its id first, until a player has no unit left
+     * @param field
+     * @param maxTurns the unfinished games are draws after this number of turns
+     * @return the score of the player (the wins plus half the draws, over the games)
+     */
+    float run(const BattleField &field, int maxTurns);
+
+    int getWins() const
+    {
+        return mWins;
+    }
+
+    int getDraws() const
+    {
+        return mDraws;
+    }
+
+    int getLosses() const
+    {
+        return mLosses;
+    }
+
+    /**
+     * @brief getTurns
+     * @return the number of turns played by the last run (all the games)
+     */
+    quint64 getTurns() const
+    {
+        return mTurns;
+    }
+
+private:
+    /**
+     * @brief EMPTY a field without unit, and the field of a dead unit
+     */
+    static const quint16 EMPTY = 0xFFFF;
+
+    /**
+     * @brief ROUNDS random moves tried in each game before going through all of them
+     */
+    static const int ROUNDS = 4;
+
+    /**
+     * @brief random next random number of a game (xorshift)
+     * @param game
+     * @return
+     */
+    quint32 random(int game)
+    {
+        quint64 &state = mRandom[game];
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return quint32(state >> 32);
+    }
+
+    /**
+     * @brief load sets all the games to the given field
+     * @param field
+     */
+    void load(const BattleField &field);
+
+    /**
+     * @brief chooseMoves chooses the move of the player in each game
+     * (mUnit and mTo, mUnit is EMPTY when the player can't move)
+     * @param color
+     */
+    void chooseMoves(Unit::COLOR color);
+
+    /**
+     * @brief findMove goes through all the moves of a game
+     * @param game
+     * @param color
+     * @return wether the player can move
+     */
+    bool findMove(int game, Unit::COLOR color);
+
+    /**
+     * @brief play plays the chosen moves, and the attacks after them
+     * @param color
+     */
+    void play(Unit::COLOR color);
+
+    int mGames;
+
+    /**
+     * @brief mUnits number of units (the same in all the games)
+     */
+    int mUnits = 0;
+
+    /**
+     * @brief mFirst first unit of each color (the units are sorted by color)
+     */
+    int mFirst[3] = {};
+
+    /**
+     * @brief mTypes type of each unit
+     */
+    std::vector<Unit::TYPE> mTypes;
+
+    /**
+     * @brief mFields field of each unit in each game (EMPTY for a dead unit),
+     * the games of a unit are contiguous
+     */
+    std::vector<quint16> mFields;
+
+    /**
+     * @brief mBoard unit on each field in each game (EMPTY for none),
+     * the games of a field are contiguous
+     */
+    std::vector<quint16> mBoard;
+
+    /**
+     * @brief mAlive number of units of each color in each game
+     */
+    std::vector<quint16> mAlive[2];
+
+    /**
+     * @brief mOver wether each game is over
+     */
+    std::vector<quint8> mOver;
+
+    /**
+     * @brief mUnit unit moved in each game (EMPTY : none)
+     */
+    std::vector<quint16> mUnit;
+
+    /**
+     * @brief mTo field where the unit moves in each game
+     */
+    std::vector<quint16> mTo;
+
+    std::vector<quint64> mRandom;
+
+    /**
+     * @brief mPlayer the player whose chances are estimated
+     */
+    Unit::COLOR mPlayer = Unit::WHITE;
+
+    /**
+     * @brief mPlaying number of games not over
+     */
+    int mPlaying = 0;
+
+    int mWins = 0;
+
+    int mDraws = 0;
+
+    int mLosses = 0;
+
+    quint64 mTurns = 0;
+};
+
+#endif // PLAYOUTS_HPP
@@ -0,0 +1,107 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   searchcache.hpp
+ * Author: azarias
+ *
+ * Created on 25/2/2018
+ */
+#ifndef SEARCHCACHE_HPP
+#define SEARCHCACHE_HPP
+
+#include <vector>
+
+#include "coordinates.hpp"
+#include "transpositiontable.hpp"
+#include "unit.hpp"
+
+/**
+ * @brief The HistoryTable class
+ * counts, for each player, how many times moving
+ * from a field to another caused a cut in the search.
+ * Used to search these moves first
+ */
+class HistoryTable
+{
+public:
+    HistoryTable():
+        mScores(2 * Geometry::SIZE * Geometry::SIZE, 0)
+    {
+    }
+
+    /**
+     * @brief score
+     * @param color
+     * @param from
+     * @param to
+     * @return the history score of the given move
+     */
+    quint32 score(Unit::COLOR color, const Coordinates &from, const Coordinates &to) const
+    {
+        return mScores[index(color, from, to)];
+    }
+
+    /**
+     * @brief add the given move caused a cut at the given depth
+     * @param color
+     * @param from
+     * @param to
+     * @param depth
+     */
+    void add(Unit::COLOR color, const Coordinates &from, const Coordinates &to, int depth)
+    {
+        mScores[index(color, from, to)] += depth * depth;
+    }
+
+    /**
+     * @brief age halves all the scores, so that the
+     * moves of the previous turns count less
+     */
+    void age()
+    {
+        for(quint32 &score : mScores)score /= 2;
+    }
+
+private:
+    static std::size_t index(Unit::COLOR color, const Coordinates &from, const Coordinates &to)
+    {
+        return (color * Geometry::SIZE + from.index()) * Geometry::SIZE + to.index();
+    }
+
+    std::vector<quint32> mScores;
+};
+
+/**
+ * @brief The SearchCache struct
+ * everything the search learns that is
+ * still useful for the next searches
+ */
+struct SearchCache{
+    TranspositionTable table;
+
+    HistoryTable history;
+};
+
+#endif // SEARCHCACHE_HPP
@@ -0,0 +1,131 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   searchoptions.hpp
+ * Author: azarias
+ *
+ * Created on 7/3/2018
+ */
+#ifndef SEARCHOPTIONS_HPP
+#define SEARCHOPTIONS_HPP
+
+#include <QtGlobal>
+
+#include <cstddef>
+
+/**
+ * @brief The SearchOptions struct
+ * the windows of the search, its selective parts (they skip
+ * or reduce the turns that are unlikely to matter, so that the
+ * search goes deeper in the same time) and its limits
+ */
+struct SearchOptions{
+    /**
+     * @brief The STOP enum why the iterative deepening stopped :
+     * the asked depth was reached, or one of the limits
+     */
+    enum STOP {DEPTH, TIME, NODES, MEMORY};
+
+    /**
+     * @brief principalVariation the turns after the first one
+     * are searched with a null window (principal variation search)
+     */
+    bool principalVariation = true;
+
+    /**
+     * @brief aspiration each iteration starts with a window
+     * around the score of the previous one
+     */
+    bool aspiration = true;
+
+    /**
+     * @brief nullMove null move pruning : the player passes its turn,
+     * if the opponent can't do better than beta with a reduced
+     * search, the position is not searched
+     */
+    bool nullMove = true;
+
+    /**
+     * @brief lateMoveReductions turns without attack, searched
+     * late (badly ordered), are searched with a reduced depth
+     * first, and again at full depth if they are better than expected
+     */
+    bool lateMoveReductions = true;
+
+    /**
+     * @brief futility turns without attack are not searched
+     * on the last ply when the evaluation plus the margin can't
+     * reach alpha
+     */
+    bool futility = true;
+
+    /**
+     * @brief symmetries the symmetric positions (see Symmetry) share
+     * their entry of the transposition table (only the flipped ones
+     * with a network : it does not evaluate mirrored fields the same)
+     */
+    bool symmetries = true;
+
+    /**
+     * @brief futilityMargin the most a turn without attack is
+     * expected to gain (about an infantery)
+     */
+    float futilityMargin = 50.f;
+
+    /**
+     * @brief timeLimit time of the search in milliseconds (0 : no limit),
+     * the iterative deepening stops when it is over
+     * (or when the next depth would not finish in time)
+     */
+    qint64 timeLimit = 0;
+
+    /**
+     * @brief nodeLimit most positions searched (0 : no limit),
+     * the iterative deepening stops when it is reached
+     * (or when the next depth would not fit)
+     */
+    quint64 nodeLimit = 0;
+
+    /**
+     * @brief memoryLimit most bytes held by the search at the same
+     * time (0 : no limit) : the positions and turns of the searched
+     * line, that grow with the depth. The search cache is not counted,
+     * its size is fixed when it is created
+     */
+    std::size_t memoryLimit = 0;
+
+    /**
+     * @brief stopName
+     * @param stop
+     * @return the name of the stop reason (for the logs)
+     */
+    static const char *stopName(STOP stop)
+    {
+        static const char *const names[] = {"depth", "time", "nodes", "memory"};
+        return names[stop];
+    }
+};
+
+#endif // SEARCHOPTIONS_HPP
@@ -0,0 +1,94 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   searchstats.cpp
+ * Author: azarias
+ *
+ * Created on 4/3/2018
+ */
+#include "searchstats.hpp"
+
+#include <QJsonArray>
+
+#include <algorithm>
+#include <cmath>
+
+double SearchStats::branchingFactor() const
+{
+    if(iterations.empty())return 0.;
+
+    const Iteration &last = iterations.back();
+    if(iterations.size() == 1)return std::pow(double(last.nodes), 1. / std::max(last.depth, 1));
+
+    const Iteration &previous = iterations[iterations.size() - 2];
+    return previous.nodes ? double(last.nodes) / previous.nodes : 0.;
+}
+
+qint64 SearchStats::time() const
+{
+    qint64 total = 0;
+    for(const Iteration &iteration : iterations)total += iteration.time;
+    return total;
+}
+
+QJsonObject SearchStats::toJson() const
+{
+    QJsonArray iterationsJson;
+    for(const Iteration &iteration : iterations){
+        QJsonObject obj;
+        obj["depth"] = iteration.depth;
+        obj["nodes"] = qint64(iteration.nodes);
+        obj["time"] = iteration.time;
+        obj["score"] = iteration.score;
+        obj["turn"] = qint64(iteration.turn);
+        iterationsJson.append(obj);
+    }
+
+    QJsonObject res;
+    res["nodes"] = qint64(nodes);
+    res["leaves"] = qint64(leaves);
+    res["table_probes"] = qint64(tableProbes);
+    res["table_hits"] = qint64(tableHits);
+    res["table_cutoffs"] = qint64(tableCutoffs);
+    res["table_hit_rate"] = tableHitRate();
+    res["table_probe_ns"] = probeLatency();
+    res["tablebase_hits"] = qint64(tablebaseHits);
+    res["cutoffs"] = qint64(cutoffs);
+    res["first_move_cutoff_rate"] = firstMoveCutoffRate();
+    QJsonArray stages;
+    for(quint64 cutoffs : stageCutoffs)stages.append(qint64(cutoffs));
+    res["stage_cutoffs"] = stages;
+    res["null_move_cutoffs"] = qint64(nullMoveCutoffs);
+    res["reductions"] = qint64(reductions);
+    res["researches"] = qint64(researches);
+    res["futility_prunes"] = qint64(futilityPrunes);
+    res["scout_researches"] = qint64(scoutResearches);
+    res["aspiration_failures"] = qint64(aspirationFailures);
+    res["peak_memory"] = qint64(peakMemory);
+    res["branching_factor"] = branchingFactor();
+    res["time"] = time();
+    res["iterations"] = iterationsJson;
+    return res;
+}
@@ -0,0 +1,216 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   searchstats.hpp
+ * Author: azarias
+ *
+ * Created on 4/3/2018
+ */
+#ifndef SEARCHSTATS_HPP
+#define SEARCHSTATS_HPP
+
+#include <QJsonObject>
+#include <QtGlobal>
+
+#include <array>
+#include <vector>
+
+/**
+ * @brief The SearchStats struct
+ * what happened during a search, collected by the tree
+ * only when it is given a stats struct to fill
+ */
+struct SearchStats{
+    /**
+     * @brief The Iteration struct an iteration
+     * of the iterative deepening
+     */
+    struct Iteration{
+        int depth;
+
+        /**
+         * @brief nodes nodes searched during this iteration
+         */
+        quint64 nodes;
+
+        /**
+         * @brief time duration of the iteration, in microseconds
+         */
+        qint64 time;
+
+        float score;
+
+        /**
+         * @brief turn best turn (packed)
+         */
+        quint32 turn;
+    };
+
+    /**
+     * @brief nodes positions searched
+     */
+    quint64 nodes = 0;
+
+    /**
+     * @brief leaves static evaluations
+     */
+    quint64 leaves = 0;
+
+    /**
+     * @brief tableProbes transposition table probes
+     */
+    quint64 tableProbes = 0;
+
+    /**
+     * @brief tableHits probes that found the position
+     */
+    quint64 tableHits = 0;
+
+    /**
+     * @brief tableCutoffs positions not searched thanks
+     * to the score of the transposition table
+     */
+    quint64 tableCutoffs = 0;
+
+    /**
+     * @brief tableTimedProbes probes that were timed (only some of them are)
+     */
+    quint64 tableTimedProbes = 0;
+
+    /**
+     * @brief tableProbeTime nanoseconds spent in the timed probes
+     */
+    quint64 tableProbeTime = 0;
+
+    /**
+     * @brief tablebaseHits positions found in the tablebases
+     */
+    quint64 tablebaseHits = 0;
+
+    /**
+     * @brief cutoffs beta cutoffs
+     */
+    quint64 cutoffs = 0;
+
+    /**
+     * @brief firstMoveCutoffs beta cutoffs on the first turn searched
+     * (the higher, the better the turns are ordered)
+     */
+    quint64 firstMoveCutoffs = 0;
+
+    /**
+     * @brief stageCutoffs beta cutoffs on a turn of each stage of the
+     * move generator : transposition table, attacks on high-value
+     * targets, remaining attacks, moves
+     */
+    std::array<quint64, 4> stageCutoffs = {};
+
+    /**
+     * @brief nullMoveCutoffs positions cut by a null move
+     */
+    quint64 nullMoveCutoffs = 0;
+
+    /**
+     * @brief reductions late turns searched with a reduced depth
+     */
+    quint64 reductions = 0;
+
+    /**
+     * @brief researches reduced turns searched again at full depth
+     */
+    quint64 researches = 0;
+
+    /**
+     * @brief scoutResearches turns searched again with the whole window
+     * after beating the null window
+     */
+    quint64 scoutResearches = 0;
+
+    /**
+     * @brief aspirationFailures iterations searched again
+     * with a wider window
+     */
+    quint64 aspirationFailures = 0;
+
+    /**
+     * @brief futilityPrunes turns not searched on the last ply
+     */
+    quint64 futilityPrunes = 0;
+
+    /**
+     * @brief peakMemory most bytes held by the search at the same time
+     */
+    quint64 peakMemory = 0;
+
+    std::vector<Iteration> iterations;
+
+    /**
+     * @brief firstMoveCutoffRate
+     * @return the part of the cutoffs happening on the first turn
+     */
+    double firstMoveCutoffRate() const
+    {
+        return cutoffs ? double(firstMoveCutoffs) / cutoffs : 0.;
+    }
+
+    /**
+     * @brief tableHitRate
+     * @return the part of the probes that found the position
+     */
+    double tableHitRate() const
+    {
+        return tableProbes ? double(tableHits) / tableProbes : 0.;
+    }
+
+    /**
+     * @brief probeLatency
+     * @return the mean time of a probe in nanoseconds (timer included)
+     */
+    double probeLatency() const
+    {
+        return tableTimedProbes ? double(tableProbeTime) / tableTimedProbes : 0.;
+    }
+
+    /**
+     * @brief branchingFactor effective branching factor : growth of
+     * the number of nodes between the last two iterations
+     * @return
+     */
+    double branchingFactor() const;
+
+    /**
+     * @brief time total time of the iterations, in microseconds
+     * @return
+     */
+    qint64 time() const;
+
+    /**
+     * @brief toJson
+     * @return all the counters, as a json object
+     */
+    QJsonObject toJson() const;
+};
+
+#endif // SEARCHSTATS_HPP
@@ -0,0 +1,12 @@
+#-------------------------------------------------
+#
+# Shared transposition table (POSIX shared memory),
+# shared by all the projects
+#
+# shm_open is in librt on the older glibc
+#
+#-------------------------------------------------
+
+unix:!macx {
+    LIBS += -lrt
+}
@@ -0,0 +1,15 @@
+#-------------------------------------------------
+#
+# Vector instructions of the evaluation network, shared
+# by all the projects
+#
+# SSE2 is used by default (always there on x86-64),
+# qmake CONFIG+=avx2 builds the network kernels for
+# AVX2 ; other processors use the scalar kernels
+#
+#-------------------------------------------------
+
+avx2 {
+    gcc|clang: QMAKE_CXXFLAGS += -mavx2
+    msvc: QMAKE_CXXFLAGS += /arch:AVX2
+}
@@ -0,0 +1,97 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   symmetry.hpp
+ * Author: azarias
+ *
+ * Created on 13/3/2018
+ */
+#ifndef SYMMETRY_HPP
+#define SYMMETRY_HPP
+
+#include <QtGlobal>
+
+#include "geometry.hpp"
+#include "unit.hpp"
+
+/**
+ * @brief The Symmetry struct
+ * the rules don't change when the battlefield is mirrored
+ * (left and right), nor when it is flipped (top and bottom) with
+ * the colors swapped : the white units attack downwards,
+ * the black ones upwards. A symmetry is a combination of the
+ * two, each symmetry is its own inverse
+ */
+struct Symmetry{
+    /**
+     * @brief The TYPE enum the four symmetries
+     * (MIRROR_FLIP = MIRROR | FLIP)
+     */
+    enum TYPE {IDENTITY = 0, MIRROR = 1, FLIP = 2, MIRROR_FLIP = 3};
+
+    static const int COUNT = 4;
+
+    /**
+     * @brief field
+     * @param symmetry
+     * @param index
+     * @return the index of the field the given field becomes
+     */
+    static quint16 field(int symmetry, quint16 index)
+    {
+        int x = index % Geometry::WIDTH, y = index / Geometry::WIDTH;
+        if(symmetry & MIRROR)x = Geometry::WIDTH - 1 - x;
+        if(symmetry & FLIP)y = Geometry::HEIGHT - 1 - y;
+        return y * Geometry::WIDTH + x;
+    }
+
+    /**
+     * @brief color
+     * @param symmetry
+     * @param color
+     * @return the color the given color becomes
+     */
+    static Unit::COLOR color(int symmetry, Unit::COLOR color)
+    {
+        if(!(symmetry & FLIP))return color;
+        return color == Unit::WHITE ? Unit::BLACK : Unit::WHITE;
+    }
+
+    /**
+     * @brief turn
+     * @param symmetry
+     * @param packed a packed turn (see Turn::pack)
+     * @return the packed turn the given one becomes
+     */
+    static quint32 turn(int symmetry, quint32 packed)
+    {
+        if(!packed || symmetry == IDENTITY)return packed;
+        quint32 moved = field(symmetry, packed & 0x3FF) | (quint32(field(symmetry, (packed >> 10) & 0x3FF)) << 10);
+        if(packed & (1u << 20))moved |= (1u << 20) | (quint32(field(symmetry, (packed >> 21) & 0x3FF)) << 21);
+        return moved;
+    }
+};
+
+#endif // SYMMETRY_HPP
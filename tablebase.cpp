@@ -0,0 +1,232 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   tablebase.cpp
+ * Author: azarias
+ *
+ * Created on 22/2/2018
+ */
+#include "tablebase.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <QDebug>
+#include <QDir>
+
+namespace {
+
+const char unitLetters[] = {'S', 'L', 'R'};
+
+/**
+ * @brief sortedUnits units of the given color
+ * sorted by type (the order of the tables)
+ * @param field
+ * @param color
+ * @return
+ */
+std::vector<std::shared_ptr<Unit>> sortedUnits(const BattleField &field, int color)
+{
+    std::vector<std::shared_ptr<Unit>> units;
+    for(const std::shared_ptr<Unit> &unit : field.getUnits()){
+        if(unit->getColor() == color)units.push_back(unit);
+    }
+    std::stable_sort(units.begin(), units.end(), [](const std::shared_ptr<Unit> &a, const std::shared_ptr<Unit> &b){
+        return a->getType() < b->getType();
+    });
+    return units;
+}
+
+}
+
+QString Tablebase::Material::name() const
+{
+    QString res;
+    for(Unit::TYPE type : mover)res += unitLetters[type];
+    res += 'v';
+    for(Unit::TYPE type : other)res += unitLetters[type];
+    return res;
+}
+
+bool Tablebase::Material::fromName(const QString &name, Material &material)
+{
+    material = Material();
+    std::vector<Unit::TYPE> *side = &material.mover;
+    for(char c : name.toLatin1()){
+        if(c == 'v'){
+            if(side == &material.other)return false;
+            side = &material.other;
+            continue;
+        }
+        const char *letter = std::find(std::begin(unitLetters), std::end(unitLetters), c);
+        if(letter == std::end(unitLetters))return false;
+        side->push_back(static_cast<Unit::TYPE>(letter - unitLetters));
+    }
+    std::sort(material.mover.begin(), material.mover.end());
+    std::sort(material.other.begin(), material.other.end());
+    return !material.mover.empty() && !material.other.empty();
+}
+
+Tablebase::Tablebase()
+{
+
+}
+
+int Tablebase::load(const QString &directory)
+{
+    QDir dir(directory);
+    for(const QString &entry : dir.entryList(QStringList() << "*.gtb", QDir::Files)){
+        Material material;
+        if(!Material::fromName(entry.left(entry.length() - 4), material))continue;
+
+        std::unique_ptr<QFile> file(new QFile(dir.filePath(entry)));
+        if(!file->open(QIODevice::ReadOnly))continue;
+
+        quint64 size = fullSize(material) / Geometry::SIZE * Geometry::HALF_WIDTH * Geometry::HEIGHT;// the first unit is on the left half
+        if(file->size() != (qint64)(sizeof(Header) + size))continue;
+
+        const uchar *data = file->map(0, file->size());
+        if(!data)continue;
+
+        const Header *header = reinterpret_cast<const Header*>(data);
+        if(header->magic != mMagic || header->version != mVersion || header->width != Geometry::WIDTH || header->height != Geometry::HEIGHT){
+            qWarning() << "Invalid tablebase file" << entry;
+            continue;
+        }
+
+        mTables[material.name()] = {std::move(file), reinterpret_cast<const qint8*>(data + sizeof(Header))};
+        mMaxUnits = std::max(mMaxUnits, material.size());
+    }
+    return mTables.size();
+}
+
+bool Tablebase::probe(const BattleField &field, int &value) const
+{
+    if(field.numberOfUnits() > mMaxUnits)return false;
+
+    std::vector<std::shared_ptr<Unit>> mover = sortedUnits(field, field.getId());
+    std::vector<std::shared_ptr<Unit>> other = sortedUnits(field, 1 - field.getId());
+    if(mover.empty() || other.empty())return false;
+
+    Material material;
+    Coordinates squares[4];
+    int count = 0;
+    for(const auto &unit : mover){
+        material.mover.push_back(unit->getType());
+        squares[count++] = unit->getPosition();
+    }
+    for(const auto &unit : other){
+        material.other.push_back(unit->getType());
+        squares[count++] = unit->getPosition();
+    }
+
+    auto table = mTables.find(material.name());
+    if(table == mTables.end())return false;
+
+    if(field.getId() == Unit::BLACK){
+        //the tables only contain the positions where white plays
+        for(int i = 0; i < count; ++i)squares[i].y = Geometry::HEIGHT - 1 - squares[i].y;
+    }
+
+    value = table->second.values[mirroredIndex(squares, count)];
+    return true;
+}
+
+bool Tablebase::bestTurn(const BattleField &field, Turn &turn) const
+{
+    int rootValue;
+    if(!probe(field, rootValue))return false;
+
+    int bestScore = INT_MIN;
+    for(const Turn &possible : field.possibleTurns()){
+        BattleField child = field;
+        Turn copy = possible;
+        copy.applyActions(child);
+        child.setId(1 - field.getId());
+
+        int score;
+        if(sortedUnits(child, child.getId()).empty()){
+            score = 1000;//no unit left : immediate win
+        }else{
+            int value;
+            if(!probe(child, value))continue;
+            if(value < 0)score = 1000 + value;//fastest win
+            else if(value == 0)score = 0;
+            else score = -1000 + value;//longest loss
+        }
+
+        if(score > bestScore){
+            bestScore = score;
+            turn = possible;
+        }
+    }
+    return bestScore != INT_MIN;
+}
+
+QString Tablebase::fileName(const Material &material)
+{
+    return material.name() + ".gtb";
+}
+
+quint64 Tablebase::fullSize(const Material &material)
+{
+    quint64 size = 1;
+    for(int i = 0; i < material.size(); ++i)size *= Geometry::SIZE;
+    return size;
+}
+
+bool Tablebase::write(const QString &path, const Material &material, const std::vector<qint8> &values)
+{
+    if(material.size() > 4 || values.size() != fullSize(material))return false;
+
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))return false;
+
+    Header header = {mMagic, mVersion, Geometry::WIDTH, Geometry::HEIGHT, (quint8)material.mover.size(), (quint8)material.other.size(), {0, 0, 0, 0}};
+    int i = 0;
+    for(Unit::TYPE type : material.mover)header.types[i++] = type;
+    for(Unit::TYPE type : material.other)header.types[i++] = type;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+    //only the positions where the first unit is on the left half are saved
+    quint64 rest = fullSize(material) / Geometry::SIZE;
+    std::vector<qint8> mirrored(Geometry::HALF_WIDTH * Geometry::HEIGHT * rest);
+    for(quint64 index = 0; index < mirrored.size(); ++index){
+        quint64 first = index / rest;
+        mirrored[index] = values[(first / Geometry::HALF_WIDTH * Geometry::WIDTH + first % Geometry::HALF_WIDTH) * rest + index % rest];
+    }
+    file.write(reinterpret_cast<const char*>(mirrored.data()), mirrored.size());
+    return true;
+}
+
+quint64 Tablebase::mirroredIndex(const Coordinates *squares, int count)
+{
+    bool mirror = squares[0].x >= Geometry::HALF_WIDTH;
+    quint64 index = squares[0].y * Geometry::HALF_WIDTH + (mirror ? Geometry::WIDTH - 1 - squares[0].x : squares[0].x);
+    for(int i = 1; i < count; ++i){
+        Coordinates square(mirror ? Geometry::WIDTH - 1 - squares[i].x : squares[i].x, squares[i].y);
+        index = index * Geometry::SIZE + square.index();
+    }
+    return index;
+}
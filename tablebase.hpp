@@ -0,0 +1,227 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   tablebase.hpp
+ * Author: azarias
+ *
+ * Created on 22/2/2018
+ */
+#ifndef TABLEBASE_HPP
+#define TABLEBASE_HPP
+
+#include <QFile>
+#include <QString>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "action.hpp"
+#include "battlefield.hpp"
+
+/**
+ * @brief The Tablebase class
+ * endgame tablebases : for each set of units (material)
+ * a file generated offline (by retrograde analysis)
+ * gives the result of every position with perfect play.
+ *
+ * To shrink the files, two symmetries are used :
+ *  - swapping the colors and flipping the board vertically
+ *    gives an equivalent position, so only the positions
+ *    where white has to play are saved
+ *  - the board can be mirrored horizontally, so only the
+ *    positions where the first unit is on the left half
+ *    of the board are saved
+ *
+ * A value is saved as one byte : v > 0 the player that has to play
+ * wins in v turns (counting both players' turns), v < 0 it looses in -v turns,
+ * 0 is a draw
+ */
+class Tablebase
+{
+public:
+    /**
+     * @brief The Material struct
+     * the units of the player that has to play (mover)
+     * and the units of its opponent, sorted by type.
+     * The name of the material is made of the units
+     * string types, e.g. "SLvR"
+     */
+    struct Material{
+        std::vector<Unit::TYPE> mover;
+
+        std::vector<Unit::TYPE> other;
+
+        /**
+         * @brief name
+         * @return the name of the material
+         */
+        QString name() const;
+
+        /**
+         * @brief fromName parses a material name
+         * @param name
+         * @param material
+         * @return wether the name is valid
+         */
+        static bool fromName(const QString &name, Material &material);
+
+        /**
+         * @brief flipped
+         * @return the same material, when the opponent has to play
+         */
+        Material flipped() const
+        {
+            return {other, mover};
+        }
+
+        /**
+         * @brief size
+         * @return the number of units
+         */
+        int size() const
+        {
+            return mover.size() + other.size();
+        }
+    };
+
+    /**
+     * @brief maxGeneratedUnits the number of units of the largest
+     * tables that can be generated (a 4 units table would be 150GB)
+     */
+    static const int maxGeneratedUnits = 3;
+
+    Tablebase();
+
+    /**
+     * @brief load maps all the tablebase files
+     * of the given directory
+     * @param directory
+     * @return the number of tables loaded
+     */
+    int load(const QString &directory);
+
+    /**
+     * @brief maxUnits
+     * @return the number of units of the largest loaded table
+     * (0 if there is no table)
+     */
+    int maxUnits() const
+    {
+        return mMaxUnits;
+    }
+
+    /**
+     * @brief probe looks for the result of the given position,
+     * for the player that has to play (the battlefield's id)
+     * @param field
+     * @param value set to the result (see the class description)
+     * @return wether there is a table for this position
+     */
+    bool probe(const BattleField &field, int &value) const;
+
+    /**
+     * @brief bestTurn finds the best turn of the position
+     * using the tables : the fastest win, a draw or the longest loss
+     * @param field
+     * @param turn
+     * @return wether the position is in the tables
+     */
+    bool bestTurn(const BattleField &field, Turn &turn) const;
+
+    /**
+     * @brief fileName
+     * @param material
+     * @return the name of the file of the given material's table
+     */
+    static QString fileName(const Material &material);
+
+    /**
+     * @brief fullSize
+     * @param material
+     * @return the number of positions of the material
+     * when no symmetry is used (number of fields ^ size)
+     */
+    static quint64 fullSize(const Material &material);
+
+    /**
+     * @brief write saves the given table
+     * @param path
+     * @param material
+     * @param values the value of each position, indexed by the
+     * squares of the units (without any symmetry) : the mover's units
+     * then the other's units, in the material's order
+     * @return wether the file was written
+     */
+    static bool write(const QString &path, const Material &material, const std::vector<qint8> &values);
+
+private:
+    /**
+     * @brief The Header struct
+     * header of the table files
+     */
+    struct Header{
+        quint32 magic;
+        quint32 version;
+        quint8 width;
+        quint8 height;
+        quint8 moverCount;
+        quint8 otherCount;
+        quint8 types[4];
+    };
+
+    /**
+     * @brief The Table struct
+     * a table loaded in memory
+     */
+    struct Table{
+        std::unique_ptr<QFile> file;
+
+        const qint8 *values;
+    };
+
+    static const quint32 mMagic = 0x31425447;// "GTB1"
+
+    static const quint32 mVersion = 1;
+
+    /**
+     * @brief mirroredIndex the index of the position in the file
+     * @param squares indexes of the fields of each unit, when white plays
+     * @param count number of units
+     * @return
+     */
+    static quint64 mirroredIndex(const Coordinates *squares, int count);
+
+    /**
+     * @brief mTables the loaded tables, by material name
+     */
+    std::map<QString, Table> mTables;
+
+    /**
+     * @brief mMaxUnits number of units of the largest table
+     */
+    int mMaxUnits = 0;
+};
+
+#endif // TABLEBASE_HPP
@@ -0,0 +1,53 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   targets.cpp
+ * Author: azarias
+ *
+ * Created on 27/2/2018
+ */
+#include "targets.hpp"
+
+constexpr Coordinates Offsets::standardMoves[];
+constexpr Coordinates Offsets::towerAttacks[];
+constexpr Coordinates Offsets::infanteryMoves[];
+constexpr Coordinates Offsets::infanteryBlackAttacks[];
+constexpr Coordinates Offsets::infanteryWhiteAttacks[];
+constexpr Coordinates Offsets::gunnerBlackAttacks[];
+constexpr Coordinates Offsets::gunnerWhiteAttacks[];
+
+//the tables are only built here : constexpr makes sure they are built at compile time
+constexpr TargetTable Targets::mStandardMoves{Offsets::standardMoves};
+constexpr TargetTable Targets::mInfanteryMoves{Offsets::infanteryMoves};
+constexpr TargetTable Targets::mTowerAttacks{Offsets::towerAttacks};
+constexpr TargetTable Targets::mInfanteryWhiteAttacks{Offsets::infanteryWhiteAttacks};
+constexpr TargetTable Targets::mInfanteryBlackAttacks{Offsets::infanteryBlackAttacks};
+constexpr TargetTable Targets::mGunnerWhiteAttacks{Offsets::gunnerWhiteAttacks};
+constexpr TargetTable Targets::mGunnerBlackAttacks{Offsets::gunnerBlackAttacks};
+constexpr ThreatTable Targets::mTowerThreats{Offsets::standardMoves, Offsets::towerAttacks};
+constexpr ThreatTable Targets::mInfanteryWhiteThreats{Offsets::infanteryMoves, Offsets::infanteryWhiteAttacks};
+constexpr ThreatTable Targets::mInfanteryBlackThreats{Offsets::infanteryMoves, Offsets::infanteryBlackAttacks};
+constexpr ThreatTable Targets::mGunnerWhiteThreats{Offsets::standardMoves, Offsets::gunnerWhiteAttacks};
+constexpr ThreatTable Targets::mGunnerBlackThreats{Offsets::standardMoves, Offsets::gunnerBlackAttacks};
@@ -0,0 +1,257 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   targets.hpp
+ * Author: azarias
+ *
+ * Created on 27/2/2018
+ */
+#ifndef TARGETS_HPP
+#define TARGETS_HPP
+
+#include <QtGlobal>
+
+#include "coordinates.hpp"
+#include "unit.hpp"
+
+/**
+ * @brief The Offsets struct
+ * the moves and attacks of each unit type,
+ * relatively to the position of the unit
+ */
+struct Offsets{
+    static constexpr Coordinates standardMoves[] = {{1,1},{0,1},{-1,1},{-1,0},{-1,-1},{0,-1},{1,-1},{1,0}};
+
+    static constexpr Coordinates towerAttacks[] = {
+        {1,1},{0,1},{-1,1},{-1,0},{-1,-1},{0,-1},{1,-1},{1,0},//all around
+        {2,2},{0,2},{-2,2},{-2,0},{-2,-2},{0,-2},{2,-2},{2,0}//double range
+    };
+
+    static constexpr Coordinates infanteryMoves[] = {
+        {1,1},{0,1},{-1,1},{-1,0},{-1,-1},{0,-1},{1,-1},{1,0},//all around
+        {2,2},{0,2},{-2,2},{-2,0},{-2,-2},{0,-2},{2,-2},{2,0}//double range
+    };
+
+    static constexpr Coordinates infanteryBlackAttacks[] = {{1,0},{-1,0},{0,-1}};
+
+    static constexpr Coordinates infanteryWhiteAttacks[] = {{1,0},{-1,0},{0,1}};
+
+    static constexpr Coordinates gunnerBlackAttacks[] = {
+        {1,0},{2,0},{-1,0},{-2,0},//side
+        {0,-1},{0,-2},{0,-3}//front
+    };
+
+    static constexpr Coordinates gunnerWhiteAttacks[] = {
+        {1,0},{2,0},{-1,0},{-2,0},//side
+        {0,1},{0,2},{0,3}//front
+    };
+};
+
+/**
+ * @brief The FieldList struct
+ * the indexes of the fields a unit can reach
+ * (all of them inside the battlefield)
+ */
+template<int CAPACITY>
+struct FieldList{
+    int size = 0;
+
+    quint16 fields[CAPACITY] = {};
+
+    const quint16 *begin() const
+    {
+        return fields;
+    }
+
+    const quint16 *end() const
+    {
+        return fields + size;
+    }
+};
+
+/**
+ * @brief TargetList fields reached with a single move or attack
+ */
+using TargetList = FieldList<16>;
+
+/**
+ * @brief ThreatList fields reached with a move followed by an attack
+ */
+using ThreatList = FieldList<64>;
+
+/**
+ * @brief The TargetTable struct
+ * for each field of the battlefield, the list of
+ * the fields reached with the given offsets,
+ * built at compile time
+ */
+struct TargetTable{
+    TargetList lists[Geometry::SIZE];
+
+    template<std::size_t N>
+    constexpr TargetTable(const Coordinates (&offsets)[N]):
+        lists()
+    {
+        for(int field = 0; field < Geometry::SIZE; ++field){
+            for(std::size_t i = 0; i < N; ++i){
+                Coordinates target = Coordinates::fromIndex(field) + offsets[i];
+                if(target.isValid()){
+                    TargetList &list = lists[field];
+                    list.fields[list.size++] = target.index();
+                }
+            }
+        }
+    }
+
+    const TargetList &operator[](int field) const
+    {
+        return lists[field];
+    }
+};
+
+/**
+ * @brief The ThreatTable struct
+ * for each field of the battlefield, the list of
+ * the fields a unit standing there can attack during
+ * its turn : every attack from every field it can move to
+ * (whether the fields are free or not), built at compile time
+ */
+struct ThreatTable{
+    ThreatList lists[Geometry::SIZE];
+
+    template<std::size_t M, std::size_t A>
+    constexpr ThreatTable(const Coordinates (&moves)[M], const Coordinates (&attacks)[A]):
+        lists()
+    {
+        for(int field = 0; field < Geometry::SIZE; ++field){
+            bool reached[Geometry::SIZE] = {};
+            reached[field] = true;//the field left by the unit is empty
+            for(std::size_t m = 0; m < M; ++m){
+                Coordinates moved = Coordinates::fromIndex(field) + moves[m];
+                if(!moved.isValid())continue;
+                for(std::size_t a = 0; a < A; ++a){
+                    Coordinates target = moved + attacks[a];
+                    if(target.isValid() && !reached[target.index()]){
+                        reached[target.index()] = true;
+                        ThreatList &list = lists[field];
+                        list.fields[list.size++] = target.index();
+                    }
+                }
+            }
+        }
+    }
+
+    const ThreatList &operator[](int field) const
+    {
+        return lists[field];
+    }
+};
+
+/**
+ * @brief The Targets class
+ * the fields where a unit can move, or that it
+ * can attack, from any field of the battlefield.
+ * All the bounds checks are done at compile time
+ */
+class Targets
+{
+public:
+    /**
+     * @brief moves
+     * @param type
+     * @param field index of the field of the unit
+     * @return the fields where a unit of the given type can move
+     */
+    static const TargetList &moves(Unit::TYPE type, int field)
+    {
+        return type == Unit::INFANTERY ? mInfanteryMoves[field] : mStandardMoves[field];
+    }
+
+    /**
+     * @brief attacks
+     * @param type
+     * @param color
+     * @param field index of the field of the unit
+     * @return the fields a unit of the given type and color can attack
+     */
+    static const TargetList &attacks(Unit::TYPE type, Unit::COLOR color, int field)
+    {
+        switch(type){
+        case Unit::MOBILE_TOWER:
+            return mTowerAttacks[field];
+        case Unit::INFANTERY:
+            return color == Unit::WHITE ? mInfanteryWhiteAttacks[field] : mInfanteryBlackAttacks[field];
+        default:
+            return color == Unit::WHITE ? mGunnerWhiteAttacks[field] : mGunnerBlackAttacks[field];
+        }
+    }
+
+    /**
+     * @brief threats
+     * @param type
+     * @param color
+     * @param field index of the field of the unit
+     * @return the fields a unit of the given type and color
+     * can attack during its turn (after its move)
+     */
+    static const ThreatList &threats(Unit::TYPE type, Unit::COLOR color, int field)
+    {
+        switch(type){
+        case Unit::MOBILE_TOWER:
+            return mTowerThreats[field];
+        case Unit::INFANTERY:
+            return color == Unit::WHITE ? mInfanteryWhiteThreats[field] : mInfanteryBlackThreats[field];
+        default:
+            return color == Unit::WHITE ? mGunnerWhiteThreats[field] : mGunnerBlackThreats[field];
+        }
+    }
+
+private:
+    static const TargetTable mStandardMoves;
+
+    static const TargetTable mInfanteryMoves;
+
+    static const TargetTable mTowerAttacks;
+
+    static const TargetTable mInfanteryWhiteAttacks;
+
+    static const TargetTable mInfanteryBlackAttacks;
+
+    static const TargetTable mGunnerWhiteAttacks;
+
+    static const TargetTable mGunnerBlackAttacks;
+
+    static const ThreatTable mTowerThreats;
+
+    static const ThreatTable mInfanteryWhiteThreats;
+
+    static const ThreatTable mInfanteryBlackThreats;
+
+    static const ThreatTable mGunnerWhiteThreats;
+
+    static const ThreatTable mGunnerBlackThreats;
+};
+
+#endif // TARGETS_HPP
@@ -0,0 +1,190 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   trace.cpp
+ * Author: azarias
+ *
+ * Created on 5/3/2018
+ */
+#include "trace.hpp"
+
+#ifdef GUERRILLA_TRACING
+
+#include <QFile>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct Event{
+    const char *name;
+    qint64 start;
+    qint64 duration;
+};
+
+/**
+ * @brief The Track struct the events of a thread
+ */
+struct Track{
+    int id;
+    QString name;
+    std::mutex mutex;//only taken by the thread, and when writing
+    std::vector<Event> events;
+};
+
+std::atomic<bool> recording(false);
+std::mutex tracksMutex;
+std::vector<std::unique_ptr<Track>> tracks;
+QString tracePath;
+
+thread_local Track *threadTrack = nullptr;
+
+qint64 now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief currentTrack the track of the calling thread,
+ * created the first time the thread traces something
+ * @return
+ */
+Track &currentTrack()
+{
+    if(!threadTrack){
+        std::lock_guard<std::mutex> lock(tracksMutex);
+        tracks.emplace_back(new Track());
+        threadTrack = tracks.back().get();
+        threadTrack->id = int(tracks.size());
+        threadTrack->name = QString("thread %1").arg(threadTrack->id);
+    }
+    return *threadTrack;
+}
+
+}
+
+bool Trace::start(const QString &path)
+{
+    std::lock_guard<std::mutex> lock(tracksMutex);
+    tracePath = path;
+    for(auto &track : tracks){
+        std::lock_guard<std::mutex> trackLock(track->mutex);
+        track->events.clear();
+    }
+    recording = true;
+    return true;
+}
+
+bool Trace::stop()
+{
+    if(!recording.exchange(false))return false;
+
+    std::lock_guard<std::mutex> lock(tracksMutex);
+    QFile file(tracePath);
+    if(!file.open(QIODevice::WriteOnly))return false;
+
+    // written by hand : the traces can hold millions of events
+    QByteArray out = "{\"traceEvents\":[\n";
+    bool first = true;
+    for(auto &track : tracks){
+        std::lock_guard<std::mutex> trackLock(track->mutex);
+        if(!first)out += ",\n";
+        first = false;
+        out += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" + QByteArray::number(track->id)
+                + ",\"args\":{\"name\":\"" + track->name.toUtf8() + "\"}}";
+        for(const Event &event : track->events){
+            out += ",\n{\"ph\":\"X\",\"name\":\"";
+            out += event.name;
+            out += "\",\"pid\":1,\"tid\":" + QByteArray::number(track->id)
+                    + ",\"ts\":" + QByteArray::number(event.start / 1000.0, 'f', 3)
+                    + ",\"dur\":" + QByteArray::number(event.duration / 1000.0, 'f', 3) + "}";
+        }
+        if(out.size() > (1 << 20)){
+            file.write(out);
+            out.clear();
+        }
+    }
+    out += "\n]}\n";
+    return file.write(out) == out.size();
+}
+
+void Trace::setThreadName(const QString &name)
+{
+    Track &track = currentTrack();
+    std::lock_guard<std::mutex> lock(track.mutex);
+    track.name = name;
+}
+
+Trace::Scope::Scope(const char *name):
+    mName(name),
+    mStart(recording.load(std::memory_order_relaxed) ? now() : -1)
+{
+
+}
+
+Trace::Scope::~Scope()
+{
+    if(mStart < 0)return;
+
+    qint64 end = now();
+    Track &track = currentTrack();
+    std::lock_guard<std::mutex> lock(track.mutex);
+    track.events.push_back({mName, mStart, end - mStart});
+}
+
+#else
+
+bool Trace::start(const QString &)
+{
+    return false;
+}
+
+bool Trace::stop()
+{
+    return false;
+}
+
+void Trace::setThreadName(const QString &)
+{
+
+}
+
+Trace::Scope::Scope(const char *name):
+    mName(name),
+    mStart(-1)
+{
+
+}
+
+Trace::Scope::~Scope()
+{
+
+}
+
+#endif
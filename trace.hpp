@@ -0,0 +1,105 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   trace.hpp
+ * Author: azarias
+ *
+ * Created on 5/3/2018
+ */
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief The Trace class
+ * records how long the scopes marked with GUERRILLA_TRACE take,
+ * and writes them as chrome trace events (that can be opened
+ * with chrome://tracing or ui.perfetto.dev), one track per thread.
+ *
+ * The scopes are only compiled when GUERRILLA_TRACING is defined
+ * (qmake CONFIG+=tracing), otherwise the macro is empty
+ * and start always fails
+ */
+class Trace
+{
+public:
+    /**
+     * @brief start starts recording the traced scopes
+     * @param path the file written by stop
+     * @return wether the tracing is compiled in
+     */
+    static bool start(const QString &path);
+
+    /**
+     * @brief stop stops the recording and writes the trace file
+     * (the traced threads should be done)
+     * @return wether the file was written
+     */
+    static bool stop();
+
+    /**
+     * @brief setThreadName name of the track of the current thread
+     * @param name
+     */
+    static void setThreadName(const QString &name);
+
+    /**
+     * @brief The Scope class
+     * an event that lasts as long as the scope
+     */
+    class Scope
+    {
+    public:
+        /**
+         * @brief Scope
+         * @param name name of the event, must be a string literal
+         * (it is kept until the trace is written)
+         */
+        explicit Scope(const char *name);
+
+        ~Scope();
+
+    private:
+        const char *mName;
+
+        /**
+         * @brief mStart start of the event in nanoseconds,
+         * negative when the tracing was not started
+         */
+        qint64 mStart;
+    };
+};
+
+#ifdef GUERRILLA_TRACING
+#define GUERRILLA_TRACE_CONCAT_(a, b) a##b
+#define GUERRILLA_TRACE_CONCAT(a, b) GUERRILLA_TRACE_CONCAT_(a, b)
+#define GUERRILLA_TRACE(name) Trace::Scope GUERRILLA_TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define GUERRILLA_TRACE(name) (void)0
+#endif
+
+#endif // TRACE_HPP
@@ -0,0 +1,12 @@
+#-------------------------------------------------
+#
+# Tracing of the hot path, shared by all the projects
+#
+# qmake CONFIG+=tracing compiles the GUERRILLA_TRACE
+# scopes in, they cost nothing otherwise
+#
+#-------------------------------------------------
+
+tracing {
+    DEFINES += GUERRILLA_TRACING
+}
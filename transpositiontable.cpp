@@ -0,0 +1,329 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   transpositiontable.cpp
+ * Author: azarias
+ *
+ * Created on 25/2/2018
+ */
+#include "transpositiontable.hpp"
+#include "geometry.hpp"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <memory>
+#include <new>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/**
+ * @brief HUGE_PAGE size of the huge pages (the usual 2 MB of x86 and arm)
+ */
+const std::size_t HUGE_PAGE = 2 * 1024 * 1024;
+
+/**
+ * @brief bucketsFor
+ * @param megabytes
+ * @return the most buckets (a power of two) fitting in the given size
+ */
+std::size_t bucketsFor(std::size_t megabytes)
+{
+    std::size_t buckets = 1;
+    while(buckets * 2 * 64 <= megabytes * 1024 * 1024)buckets *= 2;
+    return buckets;
+}
+
+}
+
+const int TranspositionTable::ENTRIES;
+
+TranspositionTable::TranspositionTable(std::size_t megabytes, bool hugePages)
+{
+    resize(megabytes, hugePages);
+}
+
+TranspositionTable::~TranspositionTable()
+{
+    unshare();
+    release();
+}
+
+void TranspositionTable::resize(std::size_t megabytes, bool hugePages)
+{
+    unshare();
+    release();
+    static_assert(sizeof(Bucket) == 64, "bucketsFor counts 64 bytes per bucket");
+    const std::size_t buckets = bucketsFor(megabytes);
+    const std::size_t bytes = buckets * sizeof(Bucket);
+
+#ifdef Q_OS_UNIX
+    //anonymous memory : aligned on a page, and filled with zeros
+    void *memory = MAP_FAILED;
+    std::size_t size = bytes;
+    if(hugePages){
+        size = (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+#ifdef MAP_HUGETLB
+        //the huge pages reserved on the host (vm.nr_hugepages)
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        mHugePages = memory != MAP_FAILED;
+#endif
+    }
+    if(memory == MAP_FAILED)memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(memory == MAP_FAILED)throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    //otherwise the transparent huge pages, when the kernel has some
+    if(hugePages && !mHugePages)mHugePages = madvise(memory, size, MADV_HUGEPAGE) == 0;
+#endif
+    //the pages are touched now rather than during the first searches
+    for(std::size_t page = 0; page < size; page += 4096)static_cast<volatile char*>(memory)[page] = 0;
+    mOwnMemory = memory;
+    mOwnSize = size;
+#else
+    Q_UNUSED(hugePages);
+    mHeap.assign(bytes + sizeof(Bucket), 0);
+    mOwnMemory = mHeap.data();
+    mOwnSize = mHeap.size();
+    std::align(alignof(Bucket), bytes, mOwnMemory, mOwnSize);
+#endif
+
+    mBuckets = static_cast<Bucket*>(mOwnMemory);
+    mMask = buckets - 1;
+}
+
+void TranspositionTable::release()
+{
+#ifdef Q_OS_UNIX
+    if(mOwnMemory)munmap(mOwnMemory, mOwnSize);
+#else
+    std::vector<char>().swap(mHeap);
+#endif
+    mOwnMemory = nullptr;
+    mOwnSize = 0;
+    mHugePages = false;
+}
+
+bool TranspositionTable::share(const QString &name, std::size_t megabytes, quint64 evaluation, bool hugePages)
+{
+#ifdef Q_OS_UNIX
+    const std::size_t buckets = bucketsFor(megabytes);
+    const std::size_t bytes = sizeof(SharedHeader) + buckets * sizeof(Bucket);
+    const QByteArray path = name.toLocal8Bit();
+
+    //the first client creates the memory (filled with zeros), the others open it
+    bool created = true;
+    int fd = shm_open(path.constData(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(fd < 0 && errno == EEXIST){
+        created = false;
+        fd = shm_open(path.constData(), O_RDWR, 0600);
+    }
+    if(fd < 0){
+        qWarning() << "Could not open the shared table" << name << ":" << strerror(errno);
+        return false;
+    }
+    if(created && ftruncate(fd, bytes) != 0){
+        qWarning() << "Could not size the shared table" << name << ":" << strerror(errno);
+        ::close(fd);
+        shm_unlink(path.constData());
+        return false;
+    }
+
+    //the creator may not have sized it yet
+    struct stat status;
+    for(int wait = 0; wait < 100 && (fstat(fd, &status) != 0 || status.st_size == 0); ++wait)usleep(10000);
+    if(std::size_t(status.st_size) != bytes){
+        qWarning() << "The shared table" << name << "has another size";
+        ::close(fd);
+        return false;
+    }
+
+    void *mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(mapping == MAP_FAILED){
+        qWarning() << "Could not map the shared table" << name << ":" << strerror(errno);
+        return false;
+    }
+
+    //the magic is written last : the header is complete when it is there
+    SharedHeader *header = static_cast<SharedHeader*>(mapping);
+    volatile quint32 &magic = header->magic;
+    if(created){
+        header->version = mVersion;
+        header->width = Geometry::WIDTH;
+        header->height = Geometry::HEIGHT;
+        header->entries = buckets * ENTRIES;
+        header->evaluation = evaluation;
+        std::atomic_thread_fence(std::memory_order_release);
+        magic = mMagic;
+    }else{
+        for(int wait = 0; wait < 100 && magic != mMagic; ++wait)usleep(10000);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    if(magic != mMagic || header->version != mVersion || header->width != Geometry::WIDTH ||
+            header->height != Geometry::HEIGHT || header->entries != buckets * ENTRIES ||
+            header->evaluation != evaluation){
+        qWarning() << "The shared table" << name << "was created for another board, table or evaluation";
+        munmap(mapping, bytes);
+        return false;
+    }
+
+    unshare();
+    release();
+#ifdef MADV_HUGEPAGE
+    if(hugePages)mHugePages = madvise(mapping, bytes, MADV_HUGEPAGE) == 0;
+#else
+    Q_UNUSED(hugePages);
+#endif
+    mMapping = mapping;
+    mMappingSize = bytes;
+    mBuckets = reinterpret_cast<Bucket*>(header + 1);
+    mMask = buckets - 1;
+    return true;
+#else
+    Q_UNUSED(name);
+    Q_UNUSED(megabytes);
+    Q_UNUSED(evaluation);
+    Q_UNUSED(hugePages);
+    return false;
+#endif
+}
+
+void TranspositionTable::unshare()
+{
+#ifdef Q_OS_UNIX
+    if(mMapping)munmap(mMapping, mMappingSize);
+#endif
+    mMapping = nullptr;
+    mMappingSize = 0;
+    mBuckets = static_cast<Bucket*>(mOwnMemory);
+}
+
+void TranspositionTable::newSearch()
+{
+    if(mMapping){
+        static_assert(ATOMIC_INT_LOCK_FREE == 2, "the shared generation must be lock free");
+        mGeneration = (static_cast<SharedHeader*>(mMapping)->generation.fetch_add(1) + 1) & 63;
+    }else{
+        mGeneration = (mGeneration + 1) & 63;
+    }
+}
+
+void TranspositionTable::clear()
+{
+    std::fill(mBuckets, mBuckets + mMask + 1, Bucket());
+}
+
+bool TranspositionTable::probe(quint64 hash, Data &data) const
+{
+    const Bucket &bucket = mBuckets[hash & mMask];
+    for(const Entry &stored : bucket.entries){
+        //a copy : the entry may be written by another client meanwhile
+        const Entry entry = stored;
+        if(!entry.data || (entry.key ^ entry.data) != hash)continue;
+
+        data.turn = entry.data & 0xFFFFFFFF;
+        data.score = static_cast<qint16>((entry.data >> 32) & 0xFFFF);
+        data.depth = depthOf(entry.data);
+        data.bound = static_cast<BOUND>((entry.data >> 56) & 0x3);
+        return true;
+    }
+    return false;
+}
+
+void TranspositionTable::store(quint64 hash, quint32 turn, float score, int depth, BOUND bound)
+{
+    Bucket &bucket = mBuckets[hash & mMask];
+
+    //the entry of the position, otherwise the one worth the least :
+    //an empty one, then the shallowest of the previous searches,
+    //then the shallowest of the current one
+    Entry *replaced = nullptr;
+    Entry previous = {0, 0};
+    bool samePosition = false;
+    int lowest = INT_MAX;
+    for(Entry &entry : bucket.entries){
+        const Entry current = entry;
+        if(current.data && (current.key ^ current.data) == hash){
+            replaced = &entry;
+            previous = current;
+            samePosition = true;
+            break;
+        }
+        const int worth = !current.data ? -1 :
+                depthOf(current.data) + (generationOf(current.data) == mGeneration ? 256 : 0);
+        if(worth < lowest){
+            lowest = worth;
+            replaced = &entry;
+            previous = current;
+        }
+    }
+
+    //keep the deeper results of the current search
+    if(!samePosition && previous.data && generationOf(previous.data) == mGeneration && depthOf(previous.data) > depth)return;
+
+    //keep the best turn when the new result has none
+    if(samePosition && !turn)turn = previous.data & 0xFFFFFFFF;
+
+    const quint64 data = pack(turn, score, depth, bound, mGeneration);
+    replaced->key = hash ^ data;
+    replaced->data = data;
+}
+
+double TranspositionTable::usage() const
+{
+    const std::size_t sample = std::min<std::size_t>(1000 / ENTRIES, mMask + 1);
+    std::size_t used = 0;
+    for(std::size_t i = 0; i < sample; ++i){
+        for(const Entry &entry : mBuckets[i].entries){
+            if(entry.data)++used;
+        }
+    }
+    return sample ? double(used) / (sample * ENTRIES) : 0.;
+}
+
+quint64 TranspositionTable::pack(quint32 turn, float score, int depth, BOUND bound, quint8 generation)
+{
+    //the scores are not integers (tuned weights, network) : a bound
+    //is rounded so that it stays a bound of the real score
+    const float integer = bound == LOWER ? std::floor(score) : bound == UPPER ? std::ceil(score) : std::round(score);
+    qint16 rounded = qint16(qBound(-32000.f, integer, 32000.f));
+    return turn |
+            (quint64(quint16(rounded)) << 32) |
+            (quint64(qMin(depth, 255)) << 48) |
+            (quint64(bound) << 56) |
+            (quint64(generation) << 58);
+}
@@ -0,0 +1,332 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   transpositiontable.hpp
+ * Author: azarias
+ *
+ * Created on 25/2/2018
+ */
+#ifndef TRANSPOSITIONTABLE_HPP
+#define TRANSPOSITIONTABLE_HPP
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+/**
+ * @brief The TranspositionTable class
+ * hash table of the positions already searched,
+ * indexed by the zobrist hash of the battlefield.
+ * For each position, it keeps the best turn found,
+ * its score, and the depth of the search.
+ * The entries are grouped in buckets of a cache line : a position
+ * can be in any entry of the bucket of its hash, so that a probe
+ * only loads one line (see prefetch). The memory can be
+ * allocated in huge pages, to avoid the misses of the TLB.
+ * The table is kept from one turn to another : the positions
+ * searched during a turn are found again during the next one.
+ *
+ * The table can be shared by all the clients of the host (see share) :
+ * the entries are written without lock, the key of an entry is xored
+ * with its data so that an entry written by two processes at the
+ * same time is not found (instead of being found with wrong data).
+ * The generation of the searches is kept in the shared memory, so
+ * that the entries of the other clients (or of the dead ones) age
+ * like the client's own entries
+ */
+class TranspositionTable
+{
+public:
+    /**
+     * @brief The BOUND enum
+     * what the saved score is : the exact score,
+     * or only a bound (the search was cut)
+     */
+    enum BOUND {EXACT, LOWER, UPPER};
+
+    /**
+     * @brief The Data struct
+     * what is saved for a position
+     */
+    struct Data{
+        /**
+         * @brief turn best turn found (see Turn::pack)
+         */
+        quint32 turn;
+
+        float score;
+
+        int depth;
+
+        BOUND bound;
+    };
+
+    /**
+     * @brief ENTRIES number of entries of a bucket
+     */
+    static const int ENTRIES = 4;
+
+    /**
+     * @brief TranspositionTable creates a table
+     * @param megabytes size of the table
+     * @param hugePages wether to allocate the table in huge pages (see resize)
+     */
+    explicit TranspositionTable(std::size_t megabytes = 16, bool hugePages = false);
+
+    ~TranspositionTable();
+
+    TranspositionTable(const TranspositionTable &) = delete;
+
+    TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+    /**
+     * @brief share replaces the entries by the ones of the POSIX shared
+     * memory of the given name, created if it does not exist yet. It is
+     * kept when the process ends : the next clients start with its entries
+     * (unix only)
+     * @param name name of the shared memory (starting with a /)
+     * @param megabytes size of the table, must be the same for all the clients
+     * @param evaluation checksum of the evaluation of the client (see Evaluation::checksum),
+     * the clients evaluating differently can't share their scores
+     * @param hugePages wether to advise the kernel to back the memory with
+     * huge pages (only done when the shared memory huge pages are enabled)
+     * @return wether the table is shared (the table is not changed otherwise)
+     */
+    bool share(const QString &name, std::size_t megabytes, quint64 evaluation, bool hugePages = false);
+
+    /**
+     * @brief isShared
+     * @return wether the entries are in shared memory
+     */
+    bool isShared() const
+    {
+        return mMapping != nullptr;
+    }
+
+    /**
+     * @brief hasHugePages
+     * @return wether the table was allocated in huge pages (explicit ones,
+     * or transparent ones the kernel was advised to use)
+     */
+    bool hasHugePages() const
+    {
+        return mHugePages;
+    }
+
+    /**
+     * @brief resize changes the size of the table
+     * (all the entries are lost, the table is not shared anymore)
+     * @param megabytes
+     * @param hugePages wether to allocate the table in huge pages : the
+     * reserved huge pages of the host if there are enough, the transparent
+     * ones otherwise (linux only, the normal pages are used when it fails)
+     */
+    void resize(std::size_t megabytes, bool hugePages = false);
+
+    /**
+     * @brief clear removes all the entries
+     * (of all the clients, if the table is shared)
+     */
+    void clear();
+
+    /**
+     * @brief newSearch must be called before each search,
+     * the entries of the previous searches are replaced first
+     * (the clients of a shared table count their searches together)
+     */
+    void newSearch();
+
+    /**
+     * @brief probe looks for the given position
+     * @param hash
+     * @param data set to the saved data if found
+     * @return wether the position was found
+     */
+    bool probe(quint64 hash, Data &data) const;
+
+    /**
+     * @brief prefetch starts loading the bucket of the given position,
+     * to be called as soon as the position is known, long enough
+     * before it is probed
+     * @param hash
+     */
+    void prefetch(quint64 hash) const
+    {
+#if defined(__GNUC__)
+        __builtin_prefetch(&mBuckets[hash & mMask]);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_prefetch(reinterpret_cast<const char*>(&mBuckets[hash & mMask]), _MM_HINT_T0);
+#else
+        Q_UNUSED(hash);
+#endif
+    }
+
+    /**
+     * @brief store saves the result of the search of a position
+     * @param hash
+     * @param turn
+     * @param score
+     * @param depth
+     * @param bound
+     */
+    void store(quint64 hash, quint32 turn, float score, int depth, BOUND bound);
+
+    /**
+     * @brief size number of entries of the table
+     * @return
+     */
+    std::size_t size() const
+    {
+        return (mMask + 1) * ENTRIES;
+    }
+
+    /**
+     * @brief usage part of the table filled (from the first
+     * thousand entries, it's only an estimation)
+     * @return between 0 and 1
+     */
+    double usage() const;
+
+    /**
+     * @brief memoryUsage bytes of the entries
+     * @return
+     */
+    std::size_t memoryUsage() const
+    {
+        return (mMask + 1) * sizeof(Bucket);
+    }
+
+private:
+    /**
+     * @brief The Entry struct
+     * an entry of the table, the data is packed
+     * in 64 bits : turn (32), score (16), depth (8),
+     * bound (2) and generation (6). The key is the
+     * hash of the position xored with the data
+     */
+    struct Entry{
+        quint64 key;
+        quint64 data;
+    };
+
+    /**
+     * @brief The Bucket struct
+     * the entries of the positions with the same index,
+     * aligned on a cache line
+     */
+    struct alignas(64) Bucket{
+        Entry entries[ENTRIES];
+    };
+
+    /**
+     * @brief The SharedHeader struct
+     * start of the shared memory, the clients only use it if
+     * they have the same board, table size and evaluation (it takes a whole
+     * cache line, so that the buckets are aligned)
+     */
+    struct alignas(64) SharedHeader{
+        quint32 magic;
+        quint32 version;
+        quint16 width;
+        quint16 height;
+        /**
+         * @brief generation searches of all the clients
+         */
+        std::atomic<quint32> generation;
+        quint64 entries;
+        quint64 evaluation;
+    };
+
+    static const quint32 mMagic = 0x53545447;// "GTTS"
+
+    static const quint32 mVersion = 4;
+
+    /**
+     * @brief unshare unmaps the shared memory (the memory is kept)
+     */
+    void unshare();
+
+    /**
+     * @brief release frees the own buckets of the table
+     */
+    void release();
+
+    static quint64 pack(quint32 turn, float score, int depth, BOUND bound, quint8 generation);
+
+    static int depthOf(quint64 data)
+    {
+        return (data >> 48) & 0xFF;
+    }
+
+    static quint8 generationOf(quint64 data)
+    {
+        return data >> 58;
+    }
+
+    /**
+     * @brief mBuckets the buckets, the number of buckets is a power
+     * of two, the index of a position is its hash masked
+     * (the own buckets, or the shared ones)
+     */
+    Bucket *mBuckets = nullptr;
+
+    /**
+     * @brief mOwnMemory the memory of the buckets of the table when
+     * it is not shared (mapped on unix, allocated otherwise)
+     */
+    void *mOwnMemory = nullptr;
+
+    std::size_t mOwnSize = 0;
+
+#ifndef Q_OS_UNIX
+    std::vector<char> mHeap;
+#endif
+
+    /**
+     * @brief mHugePages wether the buckets are in huge pages
+     */
+    bool mHugePages = false;
+
+    /**
+     * @brief mMapping the shared memory mapped (null if not shared)
+     */
+    void *mMapping = nullptr;
+
+    std::size_t mMappingSize = 0;
+
+    quint64 mMask = 0;
+
+    /**
+     * @brief mGeneration generation of the current search
+     */
+    quint8 mGeneration = 0;
+};
+
+#endif // TRANSPOSITIONTABLE_HPP
@@ -1,75 +1,402 @@
 
 #include "tree.hpp"
+#include "trace.hpp"
+#include "movegenerator.hpp"
 #include <float.h>
+#include <algorithm>
+#include <cmath>
+#include <QElapsedTimer>
 
-Tree::Tree()
+constexpr float Tree::WIN_SCORE;
+
+namespace {
+
+/**
+ * @brief WON_BOUND scores above are won positions
+ */
+const float WON_BOUND = Tree::WIN_SCORE - 1000.f;
+
+/**
+ * @brief NULL_REDUCTION depth saved by the search after a null move
+ */
+const int NULL_REDUCTION = 2;
+
+/**
+ * @brief LATE_TURNS number of turns searched without reduction
+ */
+const std::size_t LATE_TURNS = 3;
+
+/**
+ * @brief ASPIRATION_WINDOW half width of the first window around
+ * the score of the previous iteration (half an infantery)
+ */
+const float ASPIRATION_WINDOW = 25.f;
+
+/**
+ * @brief PROBE_SAMPLING one transposition table probe out of
+ * PROBE_SAMPLING + 1 is timed for the stats
+ */
+const quint64 PROBE_SAMPLING = 15;
+
+/**
+ * @brief defaultEvaluation the evaluation used when none is given
+ */
+const Evaluation defaultEvaluation;
+
+/**
+ * @brief parentScore the score of a turn, from the score of the
+ * position it leads to : the opposite, with one more turn to win (or lose)
+ * @param childScore
+ * @return
+ */
+float parentScore(float childScore)
 {
+    if(childScore < -WON_BOUND)return -childScore - 1.f;
+    if(childScore > WON_BOUND)return -childScore + 1.f;
+    return -childScore;
+}
 
+/**
+ * @brief tablebaseScore score of a position found in the tablebases
+ * @param value
+ * @return
+ */
+float tablebaseScore(int value)
+{
+    if(value > 0)return Tree::WIN_SCORE - value;
+    if(value < 0)return -Tree::WIN_SCORE - value;
+    return 0.f;
 }
 
-void Tree::generate(std::size_t depth, const BattleField &field)
+/**
+ * @brief The MemoryAccount class the bytes held by a node
+ * of the search, counted in the total until the node returns
+ */
+class MemoryAccount
 {
-    mTreeDepth = depth;//save the depth for minmax
-    mRoot = std::make_unique<Node>();
-    genTreeNode(mRoot, field, depth, 1);
+public:
+    MemoryAccount(std::size_t &total, std::size_t &peak):
+        mTotal(total),
+        mPeak(peak)
+    {
+    }
+
+    ~MemoryAccount()
+    {
+        mTotal -= mBytes;
+    }
+
+    /**
+     * @brief set the node now holds the given bytes
+     * @param bytes
+     */
+    void set(std::size_t bytes)
+    {
+        mTotal = mTotal - mBytes + bytes;
+        mBytes = bytes;
+        mPeak = std::max(mPeak, mTotal);
+    }
+
+private:
+    std::size_t &mTotal;
+
+    std::size_t &mPeak;
+
+    std::size_t mBytes = 0;
+};
+
 }
 
-void Tree::genTreeNode(std::unique_ptr<Node> &parent, const BattleField &field, std::size_t depth, int coef)
+Tree::Tree():
+    mOwnCache(new SearchCache()),
+    mCache(*mOwnCache),
+    mEvaluation(&defaultEvaluation)
 {
-    if(depth == 0)return;
 
-    std::vector<Turn> turns = field.possibleTurns();
-    for(auto &turn : turns){
-        if(turn.getAction(0))turn.getAction(0)->setWeight(field.actionWeight(*turn.getAction(0))* coef);
-        if(turn.getAction(1))turn.getAction(1)->setWeight(field.actionWeight(*turn.getAction(1))* coef );
+}
 
-        std::unique_ptr<Node> nwNode = std::make_unique<Node>(turn);
-        BattleField copy = field;//copy field to simulate turn
-        copy.setId(1-copy.getId());//switch field id
-        turn.applyActions(copy);
+Tree::Tree(SearchCache &cache):
+    mCache(cache),
+    mEvaluation(&defaultEvaluation)
+{
+
+}
 
-        genTreeNode(nwNode, copy, depth-1, -coef);
-        parent->childs.emplace_back(std::move(nwNode));
+void Tree::generate(std::size_t depth, const BattleField &field)
+{
+    GUERRILLA_TRACE("search");
+    mBestTurn = Turn();
+    mBestScore = 0.f;
+    mDepth = 0;
+    mNodes = 0;
+    mMemory = 0;
+    mPeakMemory = 0;
+    mAborted = false;
+    mStopReason = SearchOptions::DEPTH;
+    mPrincipalVariation.clear();
+    mTimer.start();
+    mCache.table.newSearch();
+    mCache.history.age();
+
+    //the positions searched follow the evaluation network (copies of the root)
+    std::unique_ptr<BattleField> networkRoot;
+    const Network *network = mEvaluation->getNetwork();
+    if(network && field.getNetwork() != network){
+        networkRoot.reset(new BattleField(field));
+        networkRoot->setNetwork(network);
     }
+    const BattleField &root = networkRoot ? *networkRoot : field;
+
+    QElapsedTimer timer;
+    for(std::size_t iteration = 1; iteration <= depth; ++iteration){
+        quint64 nodes = 0;
+        if(mStats){
+            timer.start();
+            nodes = mStats->nodes;
+        }
+
+        Turn previousBest = mBestTurn;
+        float score;
+        {
+            GUERRILLA_TRACE("search iteration");
+
+            //aspiration window : the score should be close to the previous one,
+            //the window is widened each time the score falls out of it
+            float delta = ASPIRATION_WINDOW;
+            float low = -FLT_MAX, high = FLT_MAX;
+            if(mOptions.aspiration && mDepth > 0 && std::fabs(mBestScore) < WON_BOUND){
+                low = mBestScore - delta;
+                high = mBestScore + delta;
+            }
+            for(;;){
+                score = search(root, iteration, 0, low, high);
+                if(mAborted || (score > low && score < high))break;
+
+                if(mStats)++mStats->aspirationFailures;
+                delta *= 4.f;
+                if(score <= low)low = delta > WON_BOUND ? -FLT_MAX : score - delta;
+                else high = delta > WON_BOUND ? FLT_MAX : score + delta;
+            }
+        }
 
+        if(mAborted){
+            mBestTurn = previousBest;//the iteration is not finished, its turn is not reliable
+            break;
+        }
+        mBestScore = score;
+        mDepth = iteration;
+        mPrincipalVariation = mPv[0];
+
+        if(mStats){
+            mStats->iterations.push_back({int(iteration), mStats->nodes - nodes, timer.nsecsElapsed() / 1000, mBestScore, mBestTurn.pack()});
+        }
 
+        //the next iteration takes at least as long as all the previous ones
+        if(iteration < depth && mOptions.timeLimit && mTimer.elapsed() * 2 > mOptions.timeLimit){
+            mStopReason = SearchOptions::TIME;
+            break;
+        }
+        if(iteration < depth && mOptions.nodeLimit && mNodes * 2 > mOptions.nodeLimit){
+            mStopReason = SearchOptions::NODES;
+            break;
+        }
+    }
+    if(mStats)mStats->peakMemory = mPeakMemory;
 }
 
 const Turn &Tree::getBestAction() const
 {
-    float bestNodeVal = -INFINITY;
-    Turn *bestTurn = 0;
-
-    for(const auto &node : mRoot->childs){
-        float mmax = minmax(node, mTreeDepth, true);
-        if(mmax > bestNodeVal){
-            bestNodeVal = mmax;
-            bestTurn = &node->action;
-        }
-    }
+    return mBestTurn;
+}
 
-    return *bestTurn;
+std::vector<Turn> Tree::getPrincipalVariation() const
+{
+    std::vector<Turn> turns;
+    turns.reserve(mPrincipalVariation.size());
+    for(quint32 packed : mPrincipalVariation)turns.push_back(Turn::unpack(packed));
+    return turns;
 }
 
+quint64 Tree::tableKey(const BattleField &field, int &symmetry) const
+{
+    symmetry = Symmetry::IDENTITY;
+    if(!mOptions.symmetries)return field.hash();
+    //the network sees the colors flipped, but not the field mirrored
+    return field.canonicalHash(symmetry, !mEvaluation->getNetwork());
+}
+
+bool Tree::overBudget()
+{
+    if(mAborted || mDepth == 0)return mAborted;
+
+    if(mOptions.nodeLimit && mNodes >= mOptions.nodeLimit)stop(SearchOptions::NODES);
+    else if(mOptions.memoryLimit && mMemory > mOptions.memoryLimit)stop(SearchOptions::MEMORY);
+    else if(mOptions.timeLimit && (mNodes & 1023) == 0 && mTimer.elapsed() >= mOptions.timeLimit)stop(SearchOptions::TIME);
+    return mAborted;
+}
 
-float Tree::minmax(const std::unique_ptr<Node> &parent, int depth, bool maximizePlayer) const
+float Tree::search(const BattleField &field, int depth, int ply, float alpha, float beta, bool nullAllowed)
 {
-    if(parent->childs.size() == 0 || depth == 0)return parent->action.getWeight();
+    if(mStats)++mStats->nodes;
+    ++mNodes;
+    if(mPv.size() <= std::size_t(ply))mPv.resize(ply + 1);
+    mPv[ply].clear();
+    MemoryAccount memory(mMemory, mPeakMemory);
+    memory.set(field.memoryUsage());
+    if(overBudget())return 0.f;
+
+    if(field.numberOfMyUnits() == 0)return -WIN_SCORE;//no unit left : lost
+
+    int value;
+    if(ply > 0 && mTablebase && mTablebase->probe(field, value)){
+        if(mStats)++mStats->tablebaseHits;
+        return tablebaseScore(value);
+    }
+
+    if(depth == 0){
+        if(mStats)++mStats->leaves;
+        return mEvaluation->evaluate(field);
+    }
+
+    const float originalAlpha = alpha;
+    TranspositionTable::Data data;
+    quint32 tableTurn = 0;
+    //the entry of the symmetric positions is the one of the canonical position,
+    //its turn is turned back into a turn of this position
+    int symmetry = Symmetry::IDENTITY;
+    const quint64 key = tableKey(field, symmetry);
+    bool found;
+    if(mStats && (mStats->tableProbes++ & PROBE_SAMPLING) == 0){
+        //only some probes are timed, the clock costs more than a probe in the cache
+        QElapsedTimer probeTimer;
+        probeTimer.start();
+        found = mCache.table.probe(key, data);
+        mStats->tableProbeTime += probeTimer.nsecsElapsed();
+        ++mStats->tableTimedProbes;
+    }else{
+        found = mCache.table.probe(key, data);
+    }
+    if(found){
+        if(mStats)++mStats->tableHits;
+        tableTurn = Symmetry::turn(symmetry, data.turn);
+        if(ply > 0 && data.depth >= depth){
+            if(data.bound == TranspositionTable::LOWER)alpha = qMax(alpha, data.score);
+            else if(data.bound == TranspositionTable::UPPER)beta = qMin(beta, data.score);
+            if(data.bound == TranspositionTable::EXACT || alpha >= beta){
+                if(mStats)++mStats->tableCutoffs;
+                return data.score;
+            }
+        }
+    }
+
+    //the evaluation is only needed by the selective search
+    const bool selective = ply > 0 && ((mOptions.nullMove && nullAllowed && depth > NULL_REDUCTION) ||
+                                       (mOptions.futility && depth == 1));
+    const float staticEval = selective ? mEvaluation->evaluate(field) : 0.f;
 
-    if(maximizePlayer){
-        float bestVal = -9999999.f;
-        for(const auto &ptr : parent->childs){
-            float v = minmax(ptr, depth-1, false);
-            bestVal = qMax(bestVal, v);
+    //null move : if passing is already good enough for the player, playing will be
+    //(with at least two units : a single unit may have to make a bad move)
+    if(mOptions.nullMove && nullAllowed && ply > 0 && depth > NULL_REDUCTION &&
+            beta < WON_BOUND && staticEval >= beta && field.numberOfMyUnits() > 1){
+        BattleField copy = field;
+        copy.setId(1-copy.getId());
+        float v = -search(copy, depth-1-NULL_REDUCTION, ply+1, -beta, -beta + 1.f, false);
+        if(mAborted)return 0.f;
+        if(v >= beta){
+            if(mStats)++mStats->nullMoveCutoffs;
+            return beta;
         }
-        return bestVal;
     }
 
-    //minimize then
-    float bestVal = FLT_MAX;
-    for(const auto &ptr : parent->childs){
-        float v = minmax(ptr, depth-1, true);
-        bestVal = qMin(v, bestVal);
+    MoveGenerator generator(field, mCache.history, tableTurn);
+    Turn turn;
+    bool hasTurn = generator.next(turn);
+    if(!hasTurn){
+        if(mStats)++mStats->leaves;
+        return mEvaluation->evaluate(field);
     }
+
+    float bestVal = -FLT_MAX;
+    quint32 bestTurn = 0;
+    for(std::size_t i = 0; hasTurn; hasTurn = generator.next(turn), ++i){
+        const bool quiet = !turn.hasAttack();
+
+        //futility : on the last ply, a turn without attack can't bring the score up to alpha
+        if(mOptions.futility && depth == 1 && ply > 0 && quiet && bestTurn &&
+                staticEval + mOptions.futilityMargin <= alpha){
+            if(mStats)++mStats->futilityPrunes;
+            bestVal = qMax(bestVal, staticEval + mOptions.futilityMargin);
+            continue;
+        }
+
+        memory.set(field.memoryUsage() + generator.memoryUsage());//the turns of the stage
+
+        BattleField copy = field;//copy field to simulate turn
+        copy.setId(1-copy.getId());//switch field id
+        turn.applyActions(copy);
+
+        //the bucket of the child is loaded while the child starts (leaves are not probed)
+        if(depth > 1){
+            int childSymmetry;
+            mCache.table.prefetch(tableKey(copy, childSymmetry));
+        }
+
+        float v;
+        if(!bestTurn){
+            //first turn : full window
+            v = parentScore(search(copy, depth-1, ply+1, -beta, -alpha));
+        }else{
+            bool fullDepth = true;
+            if(mOptions.lateMoveReductions && quiet && depth >= 3 && i >= LATE_TURNS){
+                //late turn : reduced search first, it should fail low
+                if(mStats)++mStats->reductions;
+                v = parentScore(search(copy, depth-2, ply+1, -alpha - 1.f, -alpha));
+                fullDepth = !mAborted && v > alpha;
+                if(fullDepth && mStats)++mStats->researches;
+            }
+
+            if(fullDepth && mOptions.principalVariation){
+                //the first turn should be the best : null window to prove this one is worse
+                v = parentScore(search(copy, depth-1, ply+1, -alpha - 1.f, -alpha));
+                if(!mAborted && v > alpha && v < beta){
+                    if(mStats)++mStats->scoutResearches;
+                    v = parentScore(search(copy, depth-1, ply+1, -beta, -alpha));
+                }
+            }else if(fullDepth){
+                v = parentScore(search(copy, depth-1, ply+1, -beta, -alpha));
+            }
+        }
+        if(mAborted)return 0.f;
+
+        if(v > bestVal){
+            bestVal = v;
+            bestTurn = turn.pack();
+            if(ply == 0)mBestTurn = turn;
+        }
+        if(v > alpha){
+            //new principal variation : this turn, then the one of the reply
+            std::vector<quint32> &pv = mPv[ply];
+            pv.assign(1, turn.pack());
+            pv.insert(pv.end(), mPv[ply+1].begin(), mPv[ply+1].end());
+        }
+        alpha = qMax(alpha, v);
+        if(alpha >= beta){
+            if(mStats){
+                ++mStats->cutoffs;
+                if(i == 0)++mStats->firstMoveCutoffs;
+                ++mStats->stageCutoffs[generator.getStage() - MoveGenerator::TABLE];
+            }
+            if(!turn.hasAttack()){
+                const Action &move = *turn.getAction(0);
+                mCache.history.add(static_cast<Unit::COLOR>(field.getId()), move.getFrom(), move.getTo(), depth);
+            }
+            break;
+        }
+    }
+
+    TranspositionTable::BOUND bound = bestVal <= originalAlpha ? TranspositionTable::UPPER :
+                                      bestVal >= beta ? TranspositionTable::LOWER : TranspositionTable::EXACT;
+    mCache.table.store(key, Symmetry::turn(symmetry, bestTurn), bestVal, depth, bound);
+
     return bestVal;
 }
@@ -3,96 +3,278 @@
 
 #include "battlefield.hpp"
 #include "action.hpp"
+#include "evaluation.hpp"
+#include "searchcache.hpp"
+#include "searchoptions.hpp"
+#include "searchstats.hpp"
+#include "tablebase.hpp"
+#include <QElapsedTimer>
 #include <memory>
 #include <vector>
 
 /**
  * @brief The Tree class
  * used to calculate the best action to
- * perform, using minmax
+ * perform, using minmax (negamax with alpha-beta pruning).
+ * The tree is not kept in memory, it is searched depth-first,
+ * what was learnt is kept in a search cache (transposition
+ * table and history) that can be shared between the searches
  */
 class Tree
 {
 public:
 
     /**
-     * @brief Tree constructor
+     * @brief WIN_SCORE score of a won position,
+     * minus one for each turn needed to win
+     */
+    static constexpr float WIN_SCORE = 10000.f;
+
+    /**
+     * @brief Tree constructor, the tree uses its own
+     * search cache
      */
     Tree();
 
     /**
-     * @brief generate generates the tree nodes with the given depth,
-     * using the given battlefield as a starting state, this process
-     * can take a veeeeeery long time.
+     * @brief Tree constructor
+     * @param cache the search cache to use (and fill)
+     */
+    explicit Tree(SearchCache &cache);
+
+    /**
+     * @brief generate searches the given battlefield with the given depth,
+     * (iterative deepening : depth 1, 2, ... until the given depth
+     * or a limit of the options : the best turn of the last finished depth is kept)
+     * without limits, this process can take a veeeeeery long time.
      * @param depth
      * @param field
      */
     void generate(std::size_t depth, const BattleField &field);
 
     /**
-     * @brief getBestAction calculates the best action
-     * that can be performed using the tree generated
-     * previously
+     * @brief getBestAction the best action found
+     * by the last search (an empty turn if there is no
+     * possible turn)
      * @return
      */
     const Turn &getBestAction() const;
 
-private:
     /**
-     * @brief The Node struct
-     * internal structure used to represent
-     * a node.
-     * A node contains a Turn and a list
-     * of all the sub-nodes (or none if this node
-     * is a leaf)
+     * @brief getPrincipalVariation the turns both players are
+     * expected to play, starting with the best action (it may be
+     * shorter than the depth when the end comes from the transposition table)
+     * @return
+     */
+    std::vector<Turn> getPrincipalVariation() const;
+
+    /**
+     * @brief getBestScore the score of the best action
+     * @return
+     */
+    float getBestScore() const
+    {
+        return mBestScore;
+    }
+
+    /**
+     * @brief getDepth
+     * @return the depth of the last iteration the search
+     * finished (lower than asked when the time ran out)
+     */
+    int getDepth() const
+    {
+        return mDepth;
+    }
+
+    /**
+     * @brief getNodes
+     * @return the nodes searched by the last search
+     */
+    quint64 getNodes() const
+    {
+        return mNodes;
+    }
+
+    /**
+     * @brief getPeakMemory
+     * @return the most bytes held by the last search
      */
-    struct Node{
+    std::size_t getPeakMemory() const
+    {
+        return mPeakMemory;
+    }
 
-        Node(){}
+    /**
+     * @brief getStopReason
+     * @return why the last search stopped deepening
+     */
+    SearchOptions::STOP getStopReason() const
+    {
+        return mStopReason;
+    }
 
-        /**
-         * @brief Node constructor
-         * @param t
-         */
-        Node(const Turn &t):action(t){}
+    /**
+     * @brief setOptions sets the selective search and the limits
+     * @param options
+     */
+    void setOptions(const SearchOptions &options)
+    {
+        mOptions = options;
+    }
 
-        Turn action;
+    /**
+     * @brief setTablebase sets the tablebases probed during the
+     * search : the positions found in the tables are not searched
+     * @param tablebase
+     */
+    void setTablebase(const Tablebase *tablebase)
+    {
+        mTablebase = tablebase;
+    }
 
+    /**
+     * @brief setEvaluation sets the evaluation of the leaves
+     * (the default weights are used otherwise)
+     * @param evaluation
+     */
+    void setEvaluation(const Evaluation *evaluation)
+    {
+        mEvaluation = evaluation;
+    }
 
-        std::vector<std::unique_ptr<Node>> childs;
-    };
+    /**
+     * @brief setStats sets the stats filled by the next searches
+     * (nothing is collected without stats)
+     * @param stats
+     */
+    void setStats(SearchStats *stats)
+    {
+        mStats = stats;
+    }
 
+private:
     /**
-     * @brief genTreeNode generate a node of the tree (recursive function)
-     * Calculates all the possible move of the given field and creates all the
-     * corresponding nodes
-     * @param parent the parent node
+     * @brief search searches the given field (recursive function),
+     * principal variation search : the first turn is searched with
+     * the whole window, the others with a null window, and again
+     * with the whole window when they turn out to be better
      * @param field the current state of the field
-     * @param depth the actual depth of the tree, the function stops whenever the depth = 0
-     * @param coef the multiplication coef for the weight of each actions
+     * @param depth the remaining depth, the field is evaluated when the depth = 0
+     * @param ply the distance from the root
+     * @param alpha the score the player is already sure to get
+     * @param beta the score the opponent is already sure to get
+     * @param nullAllowed wether the player may pass its turn (not twice in a row)
+     * @return the score of the field, for the player that has to play
+     * (meaningless when the search was aborted)
      */
-    void genTreeNode(std::unique_ptr<Node> &parent, const BattleField &field, std::size_t depth, int coef);
+    float search(const BattleField &field, int depth, int ply, float alpha, float beta, bool nullAllowed = true);
 
     /**
-     * @brief minmax performs the minmax for the given node, and return the highest possible
-     * score
-     * @param parent
-     * @param depth
-     * @param maximizePlayer
-     * @return the minmax score of the given node
+     * @brief tableKey the key of the given field in the transposition table
+     * @param field
+     * @param symmetry set to the symmetry turning the field into the position of the key
+     * @return
+     */
+    quint64 tableKey(const BattleField &field, int &symmetry) const;
+
+    /**
+     * @brief overBudget checks the limits of the options (the time
+     * only every few nodes), never before the first iteration is finished
+     * @return wether the search must be aborted
+     */
+    bool overBudget();
+
+    /**
+     * @brief stop aborts the current iteration
+     * @param reason
+     */
+    void stop(SearchOptions::STOP reason)
+    {
+        mAborted = true;
+        mStopReason = reason;
+    }
+
+    /**
+     * @brief mOwnCache the cache used when none is given
+     */
+    std::unique_ptr<SearchCache> mOwnCache;
+
+    /**
+     * @brief mCache the cache used by the search
+     */
+    SearchCache &mCache;
+
+    /**
+     * @brief mBestTurn best turn found by the last search
+     */
+    Turn mBestTurn;
+
+    /**
+     * @brief mBestScore score of the best turn
+     */
+    float mBestScore = 0.f;
+
+    /**
+     * @brief mPrincipalVariation packed turns of the principal
+     * variation of the last finished iteration
+     */
+    std::vector<quint32> mPrincipalVariation;
+
+    /**
+     * @brief mPv for each ply, the principal variation of the
+     * position being searched (packed turns)
+     */
+    std::vector<std::vector<quint32>> mPv;
+
+    /**
+     * @brief mTablebase the tablebases (may be null)
+     */
+    const Tablebase *mTablebase = nullptr;
+
+    /**
+     * @brief mEvaluation the evaluation of the leaves
+     */
+    const Evaluation *mEvaluation;
+
+    /**
+     * @brief mStats the stats to fill (may be null)
+     */
+    SearchStats *mStats = nullptr;
+
+    SearchOptions mOptions;
+
+    /**
+     * @brief mDepth depth of the last finished iteration
      */
-    float minmax(const std::unique_ptr<Node> &parent, int depth, bool maximizePlayer) const;
+    int mDepth = 0;
 
     /**
-     * @brief mRoot
-     * the root of the tree
+     * @brief mNodes nodes searched by the current search
      */
-    std::unique_ptr<Node> mRoot;
+    quint64 mNodes = 0;
+
+    /**
+     * @brief mMemory bytes held by the search (see SearchOptions::memoryLimit)
+     */
+    std::size_t mMemory = 0;
+
+    /**
+     * @brief mPeakMemory most bytes held by the current search
+     */
+    std::size_t mPeakMemory = 0;
+
+    /**
+     * @brief mAborted wether a limit was reached during the current iteration
+     */
+    bool mAborted = false;
+
+    SearchOptions::STOP mStopReason = SearchOptions::DEPTH;
 
     /**
-     * @brief mTreeDepth depth of the tree
+     * @brief mTimer time of the current search
      */
-    std::size_t mTreeDepth = 0;
+    QElapsedTimer mTimer;
 
 };
 
@@ -30,52 +30,41 @@
  */
 #include "unit.hpp"
 #include "battlefield.hpp"
+#include "targets.hpp"
 
-//standart
-const std::vector<Coordinates> Unit::mPossibleStandardMoves = {{1,1},{0,1},{-1,1},{-1,0},{-1,-1},{0,-1},{1,-1},{1,0}};
+#include <iterator>
 
-// Mobile tower
-const std::vector<Coordinates> MobileTower::mPossibleAttacks =  {
-    {1,1},{0,1},{-1,1},{-1,0},{-1,-1},{0,-1},{1,-1},{1,0},//all around
-    {2,2},{0,2},{-2,2},{-2,0},{-2,-2},{0,-2},{2,-2},{2,0}//double range
-};
+namespace {
 
-//Infantery
-const std::vector<Coordinates> Infantery::mPossibleBlackAttacks = {{1,0},{-1,0},{0,-1}};
+//all the offsets are defined once, in the target tables
+const std::vector<Coordinates> standardMoves(std::begin(Offsets::standardMoves), std::end(Offsets::standardMoves));
 
-const std::vector<Coordinates> Infantery::mPossibleWhiteAttacks = {{1,0},{-1,0},{0,1}};
+const std::vector<Coordinates> infanteryMoves(std::begin(Offsets::infanteryMoves), std::end(Offsets::infanteryMoves));
 
-const std::vector<Coordinates> Infantery::mPossibleMoves = {
-    {1,1},{0,1},{-1,1},{-1,0},{-1,-1},{0,-1},{1,-1},{1,0},//all around
-    {2,2},{0,2},{-2,2},{-2,0},{-2,-2},{0,-2},{2,-2},{2,0}//double range
-};
+const std::vector<Coordinates> towerAttacks(std::begin(Offsets::towerAttacks), std::end(Offsets::towerAttacks));
 
-//Gunner
-const std::vector<Coordinates> Gunner::mPossibleBlackAttacks = {
-    {1,0},{2,0},{-1,0},{-2,0},//side
-    {0,-1},{0,-2},{0,-3}//front
+const std::vector<Coordinates> infanteryAttacks[2] = {
+    {std::begin(Offsets::infanteryWhiteAttacks), std::end(Offsets::infanteryWhiteAttacks)},
+    {std::begin(Offsets::infanteryBlackAttacks), std::end(Offsets::infanteryBlackAttacks)}
 };
 
-const std::vector<Coordinates> Gunner::mPossibleWhiteAttacks = {
-    {1,0},{2,0},{-1,0},{-2,0},//side
-    {0,1},{0,2},{0,3}//front
+const std::vector<Coordinates> gunnerAttacks[2] = {
+    {std::begin(Offsets::gunnerWhiteAttacks), std::end(Offsets::gunnerWhiteAttacks)},
+    {std::begin(Offsets::gunnerBlackAttacks), std::end(Offsets::gunnerBlackAttacks)}
 };
 
-
+}
 
 Unit::Unit():
+    mType(INFANTERY),
     mColor(WHITE),
     mPosition(-1,-1)
 {
 
 }
 
-const std::vector<Coordinates> &Unit::possibleMoves() const
-{
-    return mPossibleStandardMoves;
-}
-
-Unit::Unit(COLOR color, const Coordinates &position):
+Unit::Unit(TYPE type, COLOR color, const Coordinates &position):
+    mType(type),
     mColor(color),
     mPosition(position)
 {
@@ -89,39 +78,65 @@ std::shared_ptr<Unit> Unit::fromJson(const QJsonObject &obj, const Coordinates &
     COLOR c = static_cast<COLOR>(obj.value("color").toInt());
 
     switch(type){
-    case 0:
+    case MOBILE_TOWER:
         return std::make_shared<MobileTower>(c, position);
-    case 1:
+    case INFANTERY:
         return std::make_shared<Infantery>(c, position);
-    case 2:
+    case GUNNER:
         return std::make_shared<Gunner>(c, position);
     default:
         return {};
     }
 }
 
-std::vector<Turn> Unit::possibleTurns(const BattleField &field)
+const char *Unit::typeName(TYPE type)
+{
+    switch(type){
+    case MOBILE_TOWER:
+        return "S";
+    case INFANTERY:
+        return "L";
+    default:
+        return "R";
+    }
+}
+
+const std::vector<Coordinates> &Unit::movesOf(TYPE type)
+{
+    return type == INFANTERY ? infanteryMoves : standardMoves;
+}
+
+const std::vector<Coordinates> &Unit::attacksOf(TYPE type, COLOR color)
+{
+    switch(type){
+    case MOBILE_TOWER:
+        return towerAttacks;
+    case INFANTERY:
+        return infanteryAttacks[color];
+    default:
+        return gunnerAttacks[color];
+    }
+}
+
+void Unit::possibleTurns(const BattleField &field, std::vector<Turn> &possibleTurns)
 {
-    std::vector<Turn> possibleTurns;
+    const TYPE type = mType;
 
-    for(const auto& move : possibleMoves()){
-        Coordinates nwPos = mPosition + move;
-        if(field.isAccessible(nwPos)){
-            std::shared_ptr<Action> moveAction = std::make_shared<Action>(Action::MOVE, mPosition, nwPos);
+    //the target tables only contain fields inside the battlefield : no bounds check
+    for(quint16 to : Targets::moves(type, mPosition.index())){
+        if(field.unitAt(to))continue;
 
-            possibleTurns.emplace_back(moveAction);
+        Coordinates nwPos = Coordinates::fromIndex(to);
+        std::shared_ptr<Action> moveAction = std::make_shared<Action>(Action::MOVE, mPosition, nwPos);
 
-            for(const auto& attack : possibleAttacks()){
-                Coordinates attackPos = nwPos + attack;
-                if(field.isAttackable(attackPos,*this))
-                    possibleTurns.emplace_back(moveAction, std::make_shared<Action>(Action::ATTACK, nwPos, attackPos));
-            }
+        possibleTurns.emplace_back(moveAction);
 
+        for(quint16 target : Targets::attacks(type, mColor, to)){
+            const std::shared_ptr<Unit> &attacked = field.unitAt(target);
+            if(attacked && attacked->getColor() != mColor)
+                possibleTurns.emplace_back(moveAction, std::make_shared<Action>(Action::ATTACK, nwPos, Coordinates::fromIndex(target)));
         }
-
     }
-
-    return possibleTurns;
 }
 
 
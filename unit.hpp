@@ -43,7 +43,9 @@ class BattleField;
 
 /**
  * @brief The Unit class
- * the unit is
+ * the unit is a type, a color and a position : the type is
+ * a plain value (no virtual function), what a unit can do only
+ * depends on its type and color (see the target tables)
  */
 class Unit
 {
@@ -53,6 +55,12 @@ public:
      */
     enum COLOR {WHITE, BLACK};
 
+    /**
+     * @brief The TYPE enum type of the unit
+     * (same values as the ones sent by the server)
+     */
+    enum TYPE {MOBILE_TOWER, INFANTERY, GUNNER};
+
     /**
      * @brief Unit
      * empty constructor
@@ -61,11 +69,12 @@ public:
 
     /**
      * @brief Unit used to construct a unit
-     * with the given color and the given position
+     * with the given type, color and position
+     * @param type
      * @param color
      * @param position
      */
-    Unit(COLOR color, const Coordinates &position);
+    Unit(TYPE type, COLOR color, const Coordinates &position);
 
     /**
      * @brief getColor getter for the unit's color
@@ -90,28 +99,73 @@ public:
     }
 
     /**
-     * @brief clone virtual function that must
-     * be overriden by the subclass in order
-     * to be able to clone them
+     * @brief clone copy of the unit
      * @return
      */
-    virtual Unit *clone() const = 0;
+    Unit *clone() const
+    {
+        return new Unit(*this);
+    }
 
     /**
      * @brief strType string representation
-     * of the unit
+     * of the unit, for the display only
+     * @return
+     */
+    QString strType() const
+    {
+        return QString(typeName(mType));
+    }
+
+    /**
+     * @brief typeName letter of the type, on the board
+     * @param type
      * @return
      */
-    virtual QString strType() const = 0;
+    static const char *typeName(TYPE type);
+
+    /**
+     * @brief getType type of the unit
+     * @return
+     */
+    TYPE getType() const
+    {
+        return mType;
+    }
+
+    /**
+     * @brief getPosition getter for the unit's position
+     * @return
+     */
+    const Coordinates &getPosition() const{
+        return mPosition;
+    }
+
+    /**
+     * @brief movesOf
+     * @param type
+     * @return the moves a unit of the given type can make
+     * (relatively to its position)
+     */
+    static const std::vector<Coordinates> &movesOf(TYPE type);
+
+    /**
+     * @brief attacksOf
+     * @param type
+     * @param color
+     * @return the fields a unit of the given type and color
+     * can attack (relatively to its position)
+     */
+    static const std::vector<Coordinates> &attacksOf(TYPE type, COLOR color);
 
     /**
      * @brief possibleTurns
      * all the possible turns available for this
      * battlefield's own unit
      * @param field
-     * @return
+     * @param turns the turns are appended to it
      */
-    std::vector<Turn> possibleTurns(const BattleField &field);
+    void possibleTurns(const BattleField &field, std::vector<Turn> &turns);
 
     /**
      * @brief moves the unit at
@@ -125,18 +179,28 @@ public:
 
 protected:
 
-    virtual const std::vector<Coordinates> &possibleMoves() const;
+    /**
+     * @brief possibleMoves
+     * @return the moves of this unit (relatively to its position)
+     */
+    const std::vector<Coordinates> &possibleMoves() const
+    {
+        return movesOf(mType);
+    }
 
-    virtual const std::vector<Coordinates> &possibleAttacks() const = 0;
+    /**
+     * @brief possibleAttacks
+     * @return the attacks of this unit (relatively to its position)
+     */
+    const std::vector<Coordinates> &possibleAttacks() const
+    {
+        return attacksOf(mType, mColor);
+    }
 
     /**
-     * @brief possibleMoves
-     * the possible coordinates
-     * from where the unit can move
-     * the vector is initialized by default
-     * but can be changed
+     * @brief mType type of the unit
      */
-    static const std::vector<Coordinates> mPossibleStandardMoves;
+    TYPE mType;
 
     /**
      * @brief mColor color of the unit
@@ -150,136 +214,50 @@ protected:
 };
 
 /**
- * @brief The MobileTower class
- * a quit powerfull unit that moves "slowly"
- * but can attack at a very long range
+ * @brief The TypedUnit class
+ * a unit of a type known at compile time
+ * (nothing more than a Unit, only its constructor)
  */
-class MobileTower : public Unit
+template<Unit::TYPE Type>
+class TypedUnit : public Unit
 {
 public:
-    MobileTower(){}
-
-    /**
-     * @brief MobileTower full constructor
-     * @param color
-     * @param position
-     */
-    MobileTower(COLOR color, const Coordinates &position):
-        Unit(color, position)
+    TypedUnit():
+        Unit(Type, WHITE, Coordinates(-1, -1))
     {
     }
 
-    const std::vector<Coordinates> &possibleAttacks() const override
-    {
-        return mPossibleAttacks;
-    }
-
-    /**
-     * @brief clone overriden function
-     * @return
-     */
-    Unit *clone() const override
+    TypedUnit(COLOR color, const Coordinates &position):
+        Unit(Type, color, position)
     {
-        return new MobileTower(mColor, mPosition);
     }
-
-    /**
-     * @brief strType
-     * @return
-     */
-    QString strType() const override
-    {
-        return "S";
-    }
-
-private:
-    static const std::vector<Coordinates> mPossibleAttacks;
 };
 
+static_assert(sizeof(TypedUnit<Unit::MOBILE_TOWER>) == sizeof(Unit), "the typed units are units : no member can be added");
 
 /**
- * @brief The Infantery class
+ * @brief MobileTower
+ * a quit powerfull unit that moves "slowly"
+ * but can attack at a very long range
+ */
+typedef TypedUnit<Unit::MOBILE_TOWER> MobileTower;
+
+/**
+ * @brief Infantery
  * the infantery is a unit
  * quite vulnerable, but that
  * can move pretty fast compared
  * to the other units
  */
-class Infantery : public Unit
-{
-public:
-    Infantery(){}
-
-    Infantery(COLOR color, const Coordinates& position):
-        Unit(color, position)
-    {
-
-    }
-
-    Unit *clone() const override
-    {
-        return new Infantery(mColor, mPosition);
-    }
-
-    const std::vector<Coordinates> &possibleMoves() const
-    {
-        return mPossibleMoves;
-    }
-
-    const std::vector<Coordinates> &possibleAttacks() const override
-    {
-        return mColor == WHITE ? mPossibleWhiteAttacks : mPossibleBlackAttacks;
-    }
-
-
-    QString strType() const override
-    {
-        return "L";
-    }
-
-private:
-    static const std::vector<Coordinates> mPossibleMoves;
-
-    static const std::vector<Coordinates> mPossibleWhiteAttacks;
-
-    static const std::vector<Coordinates> mPossibleBlackAttacks;
-};
+typedef TypedUnit<Unit::INFANTERY> Infantery;
 
 /**
- * @brief The Gunner class
+ * @brief Gunner
  * the gunner is as slow
  * as the mobile tower
  * but can shoot further in front of it
  */
-class  Gunner : public Unit
-{
-public:
-    Gunner(){}
-
-    Gunner(COLOR color, const Coordinates &coordinates):
-        Unit(color, coordinates)
-    {
-    }
-
-    Unit *clone()  const override
-    {
-        return new Gunner(mColor, mPosition);
-    }
-
-    QString strType() const override
-    {
-        return "R";
-    }
-
-    const std::vector<Coordinates> &possibleAttacks() const override
-    {
-        return mColor == WHITE ? mPossibleWhiteAttacks : mPossibleBlackAttacks;
-    }
-
-private:
-    static const std::vector<Coordinates> mPossibleWhiteAttacks;
-
-    static const std::vector<Coordinates> mPossibleBlackAttacks;
-};
+typedef TypedUnit<Unit::GUNNER> Gunner;
 
 
 
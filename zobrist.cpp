@@ -0,0 +1,57 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   zobrist.cpp
+ * Author: azarias
+ *
+ * Created on 20/2/2018
+ */
+#include "zobrist.hpp"
+
+#include <random>
+
+quint64 Zobrist::mUnitKeys[Geometry::SIZE][3][2];
+
+quint64 Zobrist::mSideKey;
+
+/**
+ * @brief The ZobristInitializer struct
+ * fills the keys before main is called.
+ * The seed is fixed : changing it invalidates all the
+ * hashes saved in files (opening book ...)
+ */
+struct ZobristInitializer{
+    ZobristInitializer()
+    {
+        std::mt19937_64 generator(0x477565727269ULL);
+        for(auto &square : Zobrist::mUnitKeys)
+            for(auto &type : square)
+                for(auto &key : type)
+                    key = generator();
+        Zobrist::mSideKey = generator();
+    }
+};
+
+static ZobristInitializer initializer;
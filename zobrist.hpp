@@ -0,0 +1,109 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2017 azarias.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   zobrist.hpp
+ * Author: azarias
+ *
+ * Created on 20/2/2018
+ */
+#ifndef ZOBRIST_HPP
+#define ZOBRIST_HPP
+
+#include <QtGlobal>
+
+#include "coordinates.hpp"
+#include "symmetry.hpp"
+#include "unit.hpp"
+
+/**
+ * @brief The Zobrist class
+ * random keys used to hash the battlefield :
+ * the hash of a battlefield is the xor of the keys
+ * of all its units (and of the side key when black has to play)
+ * so it can be updated whenever a unit moves or dies.
+ * The keys are generated with a fixed seed, the hashes
+ * are the same from one run to another (and can be saved in files)
+ */
+class Zobrist
+{
+public:
+    /**
+     * @brief unitKey
+     * @param coords
+     * @param type
+     * @param color
+     * @return the key of a unit of the given type and color,
+     * standing at the given coordinates
+     */
+    static quint64 unitKey(const Coordinates &coords, Unit::TYPE type, Unit::COLOR color)
+    {
+        return mUnitKeys[coords.index()][type][color];
+    }
+
+    /**
+     * @brief unitKey
+     * @param unit
+     * @return the key of the given unit, at its current position
+     */
+    static quint64 unitKey(const Unit &unit)
+    {
+        return unitKey(unit.getPosition(), unit.getType(), unit.getColor());
+    }
+
+    /**
+     * @brief unitKey
+     * @param symmetry
+     * @param unit
+     * @return the key of the unit the given unit becomes with the symmetry
+     */
+    static quint64 unitKey(int symmetry, const Unit &unit)
+    {
+        return mUnitKeys[Symmetry::field(symmetry, unit.getPosition().index())][unit.getType()][Symmetry::color(symmetry, unit.getColor())];
+    }
+
+    /**
+     * @brief sideKey
+     * @return the key added to the hash when black has to play
+     */
+    static quint64 sideKey()
+    {
+        return mSideKey;
+    }
+
+private:
+    friend struct ZobristInitializer;
+
+    /**
+     * @brief mUnitKeys keys of the units, by field index, type and color
+     */
+    static quint64 mUnitKeys[Geometry::SIZE][3][2];
+
+    /**
+     * @brief mSideKey key of the side to play
+     */
+    static quint64 mSideKey;
+};
+
+#endif // ZOBRIST_HPP